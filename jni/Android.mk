@@ -31,6 +31,9 @@ include $(CLEAR_VARS)
 
 LOCAL_MODULE                  := NativeFormats-v4
 LOCAL_CFLAGS                  := -Wall
+ifeq ($(APP_OPTIM),debug)
+LOCAL_CFLAGS                  += -DZLLOGGER_DEBUG
+endif
 LOCAL_LDLIBS                  := -lz -llog
 LOCAL_STATIC_LIBRARIES        := expat
 
@@ -78,6 +81,7 @@ LOCAL_SRC_FILES               := \
 	NativeFormats/zlibrary/core/src/unix/filesystem/ZLUnixFSDir.cpp \
 	NativeFormats/zlibrary/core/src/unix/filesystem/ZLUnixFSManager.cpp \
 	NativeFormats/zlibrary/core/src/unix/filesystem/ZLUnixFileInputStream.cpp \
+	NativeFormats/zlibrary/core/src/unix/filesystem/ZLUnixMappedFileInputStream.cpp \
 	NativeFormats/zlibrary/core/src/unix/filesystem/ZLUnixFileOutputStream.cpp \
 	NativeFormats/zlibrary/core/src/unix/library/ZLUnixLibrary.cpp \
 	NativeFormats/zlibrary/text/src/model/ZLCachedMemoryAllocator.cpp \
@@ -88,6 +92,7 @@ LOCAL_SRC_FILES               := \
 	NativeFormats/zlibrary/ui/src/android/filesystem/ZLAndroidFSManager.cpp \
 	NativeFormats/zlibrary/ui/src/android/library/ZLAndroidLibraryImplementation.cpp \
 	NativeFormats/fbreader/src/bookmodel/BookModel.cpp \
+	NativeFormats/fbreader/src/bookmodel/BookModelCache.cpp \
 	NativeFormats/fbreader/src/bookmodel/BookReader.cpp \
 	NativeFormats/fbreader/src/formats/EncodedTextReader.cpp \
 	NativeFormats/fbreader/src/formats/FormatPlugin.cpp \
@@ -99,6 +104,7 @@ LOCAL_SRC_FILES               := \
 	NativeFormats/fbreader/src/formats/fb2/FB2Reader.cpp \
 	NativeFormats/fbreader/src/formats/fb2/FB2TagManager.cpp \
 	NativeFormats/fbreader/src/formats/fb2/FB2UidReader.cpp \
+	NativeFormats/fbreader/src/formats/css/CSSSelector.cpp \
 	NativeFormats/fbreader/src/formats/css/StyleSheetParser.cpp \
 	NativeFormats/fbreader/src/formats/css/StyleSheetTable.cpp \
 	NativeFormats/fbreader/src/formats/html/HtmlBookReader.cpp \
@@ -128,6 +134,8 @@ LOCAL_SRC_FILES               := \
 	NativeFormats/fbreader/src/formats/util/EntityFilesCollector.cpp \
 	NativeFormats/fbreader/src/formats/util/MergedStream.cpp \
 	NativeFormats/fbreader/src/formats/util/MiscUtil.cpp \
+	NativeFormats/fbreader/src/formats/util/StreamPrefetcher.cpp \
+	NativeFormats/fbreader/src/formats/util/TagNames.cpp \
 	NativeFormats/fbreader/src/formats/util/XMLTextStream.cpp \
 	NativeFormats/fbreader/src/formats/xhtml/XHTMLReader.cpp \
 	NativeFormats/fbreader/src/formats/doc/DocBookReader.cpp \
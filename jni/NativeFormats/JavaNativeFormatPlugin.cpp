@@ -17,12 +17,17 @@
  * 02110-1301, USA.
  */
 
+#include <cstring>
+
+#include <algorithm>
+
 #include <AndroidUtil.h>
 #include <JniEnvelope.h>
 #include <ZLFileImage.h>
 #include <FileEncryptionInfo.h>
 
 #include "fbreader/src/bookmodel/BookModel.h"
+#include "fbreader/src/bookmodel/BookModelCache.h"
 #include "fbreader/src/formats/FormatPlugin.h"
 #include "fbreader/src/library/Library.h"
 #include "fbreader/src/library/Author.h"
@@ -170,75 +175,229 @@ JNIEXPORT void JNICALL Java_org_geometerplus_fbreader_formats_NativeFormatPlugin
 	fillLanguageAndEncoding(env, javaBook, *book);
 }
 
-static bool initInternalHyperlinks(JNIEnv *env, jobject javaModel, BookModel &model) {
-	ZLCachedMemoryAllocator allocator(131072, Library::Instance().cacheDirectory(), "nlinks");
+// The links file is a sequence of pages, every page takes a separate row:
+// a header, the label entries sorted by id and the pool of the strings
+// the entries refer to; the format is read by NativeBookModel.java.
+// All the numbers are little endian.
+//   header: labels number, entries per page, index pages number,
+//           characters per pool page (4 bytes each)
+//   entry:  id offset (4), id length (2), model id length (2),
+//           model id offset (4), paragraph number (4)
+// Offsets are counted in UCS-2 characters from the start of the pool;
+// a string never crosses a page boundary.
+static const std::size_t LINKS_ROW_SIZE = 131072;
+// is larger than half of a row, so every page starts a new row
+static const std::size_t LINKS_PAGE_SIZE = LINKS_ROW_SIZE - 16;
+static const std::size_t LINKS_PAGE_CHARS = LINKS_PAGE_SIZE / 2;
+static const std::size_t LINKS_HEADER_SIZE = 16;
+static const std::size_t LINKS_ENTRY_SIZE = 16;
+
+namespace {
+
+struct LinkEntry {
+	const std::string *Utf8Id;
+	ZLUnicodeUtil::Ucs2String Id;
+	const BookModel::Label *Label;
+	uint32_t IdOffset;
+	uint32_t ModelIdOffset;
+	uint16_t ModelIdLength;
+};
+
+// UTF-8 strings are compared by memcmp(); for the characters ZLUnicodeUtil
+// converts to UCS-2 as is, it gives the same order as the comparison
+// of the UCS-2 strings, that is made by the reader
+struct LinkEntryUtf8Comparator {
+	bool operator() (const LinkEntry *entry0, const LinkEntry *entry1) const {
+		return *entry0->Utf8Id < *entry1->Utf8Id;
+	}
+};
 
-	ZLUnicodeUtil::Ucs2String ucs2id;
-	ZLUnicodeUtil::Ucs2String ucs2modelId;
+struct LinkEntryComparator {
+	bool operator() (const LinkEntry *entry0, const LinkEntry *entry1) const {
+		return entry0->Id < entry1->Id;
+	}
+};
+
+class LinksPool {
+
+public:
+	LinksPool();
+	// returns false if the string does not fit in a page
+	bool add(const ZLUnicodeUtil::Ucs2String &str, uint32_t &offset);
+	const std::vector<ZLUnicodeUtil::Ucs2String> &pages() const;
 
-	const std::map<std::string,BookModel::Label> &links = model.internalHyperlinks();
-	std::map<std::string,BookModel::Label>::const_iterator it = links.begin();
-	for (; it != links.end(); ++it) {
-		const std::string &id = it->first;
-		const BookModel::Label &label = it->second;
+private:
+	std::vector<ZLUnicodeUtil::Ucs2String> myPages;
+};
+
+}
+
+LinksPool::LinksPool() : myPages(1) {
+}
+
+bool LinksPool::add(const ZLUnicodeUtil::Ucs2String &str, uint32_t &offset) {
+	if (str.size() > LINKS_PAGE_CHARS) {
+		return false;
+	}
+	if (myPages.back().size() + str.size() > LINKS_PAGE_CHARS) {
+		myPages.push_back(ZLUnicodeUtil::Ucs2String());
+	}
+	ZLUnicodeUtil::Ucs2String &page = myPages.back();
+	offset = (myPages.size() - 1) * LINKS_PAGE_CHARS + page.size();
+	page.insert(page.end(), str.begin(), str.end());
+	return true;
+}
+
+const std::vector<ZLUnicodeUtil::Ucs2String> &LinksPool::pages() const {
+	return myPages;
+}
+
+static void writeInternalHyperlinks(const BookModel &model, ZLCachedMemoryAllocator &allocator) {
+	const BookModel::LabelMap &labels = model.internalHyperlinks();
+
+	std::vector<LinkEntry> entries;
+	entries.reserve(labels.size());
+	for (std::size_t i = 0; i < labels.size(); ++i) {
+		const BookModel::Label &label = labels.label(i);
 		if (label.Model.isNull()) {
 			continue;
 		}
-		ZLUnicodeUtil::utf8ToUcs2(ucs2id, id);
-		ZLUnicodeUtil::utf8ToUcs2(ucs2modelId, label.Model->id());
-		const std::size_t idLen = ucs2id.size() * 2;
-		const std::size_t modelIdLen = ucs2modelId.size() * 2;
-
-		char *ptr = allocator.allocate(idLen + modelIdLen + 8);
-		ZLCachedMemoryAllocator::writeUInt16(ptr, ucs2id.size());
-		ptr += 2;
-		std::memcpy(ptr, &ucs2id.front(), idLen);
-		ptr += idLen;
-		ZLCachedMemoryAllocator::writeUInt16(ptr, ucs2modelId.size());
-		ptr += 2;
-		std::memcpy(ptr, &ucs2modelId.front(), modelIdLen);
-		ptr += modelIdLen;
-		ZLCachedMemoryAllocator::writeUInt32(ptr, label.ParagraphNumber);
+		entries.push_back(LinkEntry());
+		entries.back().Utf8Id = &labels.id(i);
+		ZLUnicodeUtil::utf8ToUcs2(entries.back().Id, labels.id(i));
+		entries.back().Label = &label;
+	}
+	std::vector<LinkEntry*> sorted;
+	sorted.reserve(entries.size());
+	for (std::vector<LinkEntry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+		sorted.push_back(&*it);
+	}
+	// sorting by the UCS-2 strings takes about twice as long; they are only
+	// used when an id has characters that make the orders differ
+	std::sort(sorted.begin(), sorted.end(), LinkEntryUtf8Comparator());
+	const LinkEntryComparator ucs2Comparator;
+	for (std::size_t i = 1; i < sorted.size(); ++i) {
+		if (ucs2Comparator(sorted[i], sorted[i - 1])) {
+			std::sort(sorted.begin(), sorted.end(), ucs2Comparator);
+			break;
+		}
+	}
+
+	LinksPool pool;
+	// footnote id -> its offset in the pool
+	std::map<std::string,uint32_t> modelIdOffsets;
+	ZLUnicodeUtil::Ucs2String ucs2modelId;
+	std::vector<LinkEntry*> written;
+	written.reserve(sorted.size());
+	for (std::vector<LinkEntry*>::const_iterator it = sorted.begin(); it != sorted.end(); ++it) {
+		LinkEntry &entry = **it;
+		if (!pool.add(entry.Id, entry.IdOffset)) {
+			continue;
+		}
+		const std::string &modelId = entry.Label->ModelId;
+		entry.ModelIdOffset = 0;
+		entry.ModelIdLength = 0;
+		if (!modelId.empty()) {
+			ZLUnicodeUtil::utf8ToUcs2(ucs2modelId, modelId);
+			std::map<std::string,uint32_t>::const_iterator jt = modelIdOffsets.find(modelId);
+			if (jt != modelIdOffsets.end()) {
+				entry.ModelIdOffset = jt->second;
+			} else if (pool.add(ucs2modelId, entry.ModelIdOffset)) {
+				modelIdOffsets.insert(std::make_pair(modelId, entry.ModelIdOffset));
+			} else {
+				continue;
+			}
+			entry.ModelIdLength = ucs2modelId.size();
+		}
+		written.push_back(&entry);
+	}
+
+	const std::size_t entriesPerPage = LINKS_PAGE_SIZE / LINKS_ENTRY_SIZE;
+	const std::size_t indexPagesNumber = (written.size() + entriesPerPage - 1) / entriesPerPage;
+
+	char *ptr = allocator.allocate(LINKS_HEADER_SIZE);
+	ptr = ZLCachedMemoryAllocator::writeUInt32(ptr, written.size());
+	ptr = ZLCachedMemoryAllocator::writeUInt32(ptr, entriesPerPage);
+	ptr = ZLCachedMemoryAllocator::writeUInt32(ptr, indexPagesNumber);
+	ZLCachedMemoryAllocator::writeUInt32(ptr, LINKS_PAGE_CHARS);
+	if (written.empty()) {
+		allocator.flush();
+		return;
+	}
+
+	// the last page is cut to its real size at the end
+	char *page = 0;
+	std::size_t pageSize = 0;
+	for (std::size_t i = 0; i < written.size(); ++i) {
+		if (i % entriesPerPage == 0) {
+			page = allocator.allocate(LINKS_PAGE_SIZE);
+			std::memset(page, 0, LINKS_PAGE_SIZE);
+			ptr = page;
+		}
+		const LinkEntry &entry = *written[i];
+		ptr = ZLCachedMemoryAllocator::writeUInt32(ptr, entry.IdOffset);
+		ptr = ZLCachedMemoryAllocator::writeUInt16(ptr, entry.Id.size());
+		ptr = ZLCachedMemoryAllocator::writeUInt16(ptr, entry.ModelIdLength);
+		ptr = ZLCachedMemoryAllocator::writeUInt32(ptr, entry.ModelIdOffset);
+		ptr = ZLCachedMemoryAllocator::writeUInt32(ptr, entry.Label->ParagraphNumber);
+		pageSize = ptr - page;
+	}
+
+	const std::vector<ZLUnicodeUtil::Ucs2String> &poolPages = pool.pages();
+	for (std::vector<ZLUnicodeUtil::Ucs2String>::const_iterator it = poolPages.begin(); it != poolPages.end(); ++it) {
+		page = allocator.allocate(LINKS_PAGE_SIZE);
+		std::memset(page, 0, LINKS_PAGE_SIZE);
+		pageSize = it->size() * 2;
+		if (pageSize > 0) {
+			std::memcpy(page, &it->front(), pageSize);
+		}
 	}
+	allocator.reallocateLast(page, pageSize);
+
 	allocator.flush();
+}
 
-	jstring linksDirectoryName = env->NewStringUTF(allocator.directoryName().c_str());
-	jstring linksFileExtension = env->NewStringUTF(allocator.fileExtension().c_str());
-	jint linksBlocksNumber = allocator.blocksNumber();
+static bool initInternalHyperlinks(JNIEnv *env, jobject javaModel, const std::string &directoryName, const std::string &fileExtension, std::size_t blocksNumber) {
+	jstring linksDirectoryName = env->NewStringUTF(directoryName.c_str());
+	jstring linksFileExtension = env->NewStringUTF(fileExtension.c_str());
+	jint linksBlocksNumber = blocksNumber;
 	AndroidUtil::Method_NativeBookModel_initInternalHyperlinks->call(javaModel, linksDirectoryName, linksFileExtension, linksBlocksNumber);
 	env->DeleteLocalRef(linksDirectoryName);
 	env->DeleteLocalRef(linksFileExtension);
 	return !env->ExceptionCheck();
 }
 
-static jobject createTextModel(JNIEnv *env, jobject javaModel, ZLTextModel &model) {
+static jobject createTextModel(JNIEnv *env, jobject javaModel, const BookModelCache::TextModel &model) {
 	env->PushLocalFrame(16);
 
-	jstring id = AndroidUtil::createJavaString(env, model.id());
-	jstring language = AndroidUtil::createJavaString(env, model.language());
-	jint paragraphsNumber = model.paragraphsNumber();
+	jstring id = AndroidUtil::createJavaString(env, model.Id);
+	jstring language = AndroidUtil::createJavaString(env, model.Language);
+	jint paragraphsNumber = model.ParagraphsNumber;
 
-	const std::size_t arraysSize = model.startEntryIndices().size();
+	const std::size_t arraysSize = model.ArraysSize;
 	jintArray entryIndices = env->NewIntArray(arraysSize);
 	jintArray entryOffsets = env->NewIntArray(arraysSize);
 	jintArray paragraphLenghts = env->NewIntArray(arraysSize);
 	jintArray textSizes = env->NewIntArray(arraysSize);
 	jbyteArray paragraphKinds = env->NewByteArray(arraysSize);
-	env->SetIntArrayRegion(entryIndices, 0, arraysSize, &model.startEntryIndices().front());
-	env->SetIntArrayRegion(entryOffsets, 0, arraysSize, &model.startEntryOffsets().front());
-	env->SetIntArrayRegion(paragraphLenghts, 0, arraysSize, &model.paragraphLengths().front());
-	env->SetIntArrayRegion(textSizes, 0, arraysSize, &model.textSizes().front());
-	env->SetByteArrayRegion(paragraphKinds, 0, arraysSize, &model.paragraphKinds().front());
+	env->SetIntArrayRegion(entryIndices, 0, arraysSize, model.StartEntryIndices);
+	env->SetIntArrayRegion(entryOffsets, 0, arraysSize, model.StartEntryOffsets);
+	env->SetIntArrayRegion(paragraphLenghts, 0, arraysSize, model.ParagraphLengths);
+	env->SetIntArrayRegion(textSizes, 0, arraysSize, model.TextSizes);
+	env->SetByteArrayRegion(paragraphKinds, 0, arraysSize, model.ParagraphKinds);
+
+	jcharArray styleTable = env->NewCharArray(model.StyleTableSize);
+	env->SetCharArrayRegion(styleTable, 0, model.StyleTableSize, model.StyleTable);
 
-	jstring directoryName = env->NewStringUTF(model.allocator().directoryName().c_str());
-	jstring fileExtension = env->NewStringUTF(model.allocator().fileExtension().c_str());
-	jint blocksNumber = (jint) model.allocator().blocksNumber();
+	jstring directoryName = env->NewStringUTF(model.DirectoryName.c_str());
+	jstring fileExtension = env->NewStringUTF(model.FileExtension.c_str());
+	jint blocksNumber = (jint) model.BlocksNumber;
 
 	jobject textModel = AndroidUtil::Method_NativeBookModel_createTextModel->call(
 		javaModel,
 		id, language,
 		paragraphsNumber, entryIndices, entryOffsets,
-		paragraphLenghts, textSizes, paragraphKinds,
+		paragraphLenghts, textSizes, paragraphKinds, styleTable,
 		directoryName, fileExtension, blocksNumber
 	);
 
@@ -248,19 +407,193 @@ static jobject createTextModel(JNIEnv *env, jobject javaModel, ZLTextModel &mode
 	return env->PopLocalFrame(textModel);
 }
 
-static void initTOC(JNIEnv *env, jobject javaModel, const ContentsTree &tree) {
+// the tree is passed in the pre-order, a node is given by its depth,
+// its reference and the length of its text in the text buffer
+static void flattenTOC(const ContentsTree &tree, jint depth, std::vector<jint> &depths, std::vector<jint> &references, std::vector<jint> &textLengths, ZLUnicodeUtil::Ucs2String &text, ZLUnicodeUtil::Ucs2String &buffer) {
 	const std::vector<shared_ptr<ContentsTree> > &children = tree.children();
 	for (std::vector<shared_ptr<ContentsTree> >::const_iterator it = children.begin(); it != children.end(); ++it) {
 		const ContentsTree &child = **it;
-		jstring text = AndroidUtil::createJavaString(env, child.text());
-		const int ref = child.reference();
-		AndroidUtil::Method_NativeBookModel_addTOCItem->call(javaModel, text, ref);
-		env->DeleteLocalRef(text);
+		ZLUnicodeUtil::utf8ToUcs2(buffer, child.text());
+		text.insert(text.end(), buffer.begin(), buffer.end());
+		depths.push_back(depth);
+		references.push_back(child.reference());
+		textLengths.push_back(buffer.size());
 
-		initTOC(env, javaModel, child);
+		flattenTOC(child, depth + 1, depths, references, textLengths, text, buffer);
+	}
+}
 
-		AndroidUtil::Method_NativeBookModel_leaveTOCItem->call(javaModel);
+static void initTOC(JNIEnv *env, jobject javaModel, const ContentsTree &tree) {
+	std::vector<jint> depths, references, textLengths;
+	ZLUnicodeUtil::Ucs2String text, buffer;
+	flattenTOC(tree, 0, depths, references, textLengths, text, buffer);
+
+	jintArray javaDepths = AndroidUtil::createJavaIntArray(env, depths);
+	jintArray javaReferences = AndroidUtil::createJavaIntArray(env, references);
+	jintArray javaTextLengths = AndroidUtil::createJavaIntArray(env, textLengths);
+	jcharArray javaText = env->NewCharArray(text.size());
+	if (!text.empty()) {
+		env->SetCharArrayRegion(javaText, 0, text.size(), &text.front());
 	}
+
+	AndroidUtil::Method_NativeBookModel_setTOC->call(javaModel, javaDepths, javaReferences, javaTextLengths, javaText);
+
+	env->DeleteLocalRef(javaText);
+	env->DeleteLocalRef(javaTextLengths);
+	env->DeleteLocalRef(javaReferences);
+	env->DeleteLocalRef(javaDepths);
+}
+
+// Registers the given images in a single call. Every image is described
+// by four numbers: indices of its mime type, its file path and its encoding
+// in the array of distinct strings, and the number of its blocks; offsets
+// and sizes of the blocks of all the images go in two separate arrays.
+static void addImages(JNIEnv *env, jobject javaModel, const std::map<std::string,shared_ptr<const ZLImage> > &images, const std::vector<std::string> &ids) {
+	if (ids.empty()) {
+		return;
+	}
+	env->PushLocalFrame(16);
+
+	jobjectArray javaIds = env->NewObjectArray(ids.size(), AndroidUtil::Class_java_lang_String.j(), 0);
+	std::map<std::string,jint> stringIndices;
+	std::vector<std::string> strings;
+	std::vector<jint> descriptors, offsets, sizes;
+	descriptors.reserve(ids.size() * 4);
+	for (std::size_t i = 0; i < ids.size(); ++i) {
+		const ZLFileImage &image = (const ZLFileImage&)*images.find(ids[i])->second;
+		jstring javaId = AndroidUtil::createJavaString(env, ids[i]);
+		env->SetObjectArrayElement(javaIds, i, javaId);
+		env->DeleteLocalRef(javaId);
+
+		const std::string *imageStrings[] = { &image.mimeType(), &image.file().path(), &image.encoding() };
+		for (std::size_t j = 0; j < 3; ++j) {
+			std::map<std::string,jint>::const_iterator it = stringIndices.insert(
+				std::make_pair(*imageStrings[j], (jint)strings.size())
+			).first;
+			if (it->second == (jint)strings.size()) {
+				strings.push_back(*imageStrings[j]);
+			}
+			descriptors.push_back(it->second);
+		}
+
+		const ZLFileImage::Blocks &blocks = image.blocks();
+		descriptors.push_back(blocks.size());
+		for (ZLFileImage::Blocks::const_iterator it = blocks.begin(); it != blocks.end(); ++it) {
+			offsets.push_back((jint)it->offset);
+			sizes.push_back((jint)it->size);
+		}
+	}
+
+	jobjectArray javaStrings = env->NewObjectArray(strings.size(), AndroidUtil::Class_java_lang_String.j(), 0);
+	for (std::size_t i = 0; i < strings.size(); ++i) {
+		jstring javaString = AndroidUtil::createJavaString(env, strings[i]);
+		env->SetObjectArrayElement(javaStrings, i, javaString);
+		env->DeleteLocalRef(javaString);
+	}
+
+	AndroidUtil::Method_NativeBookModel_addImages->call(
+		javaModel, javaIds, javaStrings,
+		AndroidUtil::createJavaIntArray(env, descriptors),
+		AndroidUtil::createJavaIntArray(env, offsets),
+		AndroidUtil::createJavaIntArray(env, sizes)
+	);
+
+	env->PopLocalFrame(0);
+}
+
+static void addImages(JNIEnv *env, jobject javaModel, const std::map<std::string,shared_ptr<const ZLImage> > &images) {
+	std::vector<std::string> ids;
+	ids.reserve(images.size());
+	for (std::map<std::string,shared_ptr<const ZLImage> >::const_iterator it = images.begin(); it != images.end(); ++it) {
+		ids.push_back(it->first);
+	}
+	addImages(env, javaModel, images, ids);
+}
+
+static void addNewImages(JNIEnv *env, jobject javaModel, BookModel &model) {
+	std::vector<std::string> ids;
+	model.takeNewImageIds(ids);
+	addImages(env, javaModel, model.images(), ids);
+}
+
+// the opening pages are shown from a model of this number of paragraphs
+// while the rest of the book is parsed
+static const std::size_t PREFIX_PARAGRAPHS_NUMBER = 512;
+
+class JavaPrefixListener : public BookModel::PrefixListener {
+
+public:
+	JavaPrefixListener(JNIEnv *env, jobject javaModel, BookModel &bookModel);
+	void onPrefixReady(const ZLTextModel &model);
+
+private:
+	JNIEnv *myEnv;
+	jobject myJavaModel;
+	BookModel &myBookModel;
+};
+
+JavaPrefixListener::JavaPrefixListener(JNIEnv *env, jobject javaModel, BookModel &bookModel) : myEnv(env), myJavaModel(javaModel), myBookModel(bookModel) {
+}
+
+void JavaPrefixListener::onPrefixReady(const ZLTextModel &model) {
+	// the images referenced from the prefix must be known to Java
+	addNewImages(myEnv, myJavaModel, myBookModel);
+	if (myEnv->ExceptionCheck()) {
+		myEnv->ExceptionClear();
+		return;
+	}
+	jobject javaTextModel = createTextModel(myEnv, myJavaModel, BookModelCache::TextModel(model));
+	if (javaTextModel != 0) {
+		AndroidUtil::Method_NativeBookModel_setBookTextModelPrefix->call(myJavaModel, javaTextModel);
+		myEnv->DeleteLocalRef(javaTextModel);
+	}
+	// the prefix is optional, the parsing goes on anyway
+	if (myEnv->ExceptionCheck()) {
+		myEnv->ExceptionClear();
+	}
+}
+
+static void setFootnotes(JNIEnv *env, jobject javaModel, jobject javaTextModel, const std::vector<BookModel::FootnoteRun> &runs) {
+	env->PushLocalFrame(16);
+
+	const std::size_t runsNumber = runs.size();
+	jobjectArray ids = env->NewObjectArray(runsNumber, AndroidUtil::Class_java_lang_String.j(), 0);
+	std::vector<jint> starts(runsNumber);
+	for (std::size_t i = 0; i < runsNumber; ++i) {
+		jstring id = AndroidUtil::createJavaString(env, runs[i].Id);
+		env->SetObjectArrayElement(ids, i, id);
+		env->DeleteLocalRef(id);
+		starts[i] = runs[i].StartParagraph;
+	}
+	jintArray javaStarts = env->NewIntArray(runsNumber);
+	if (runsNumber > 0) {
+		env->SetIntArrayRegion(javaStarts, 0, runsNumber, &starts.front());
+	}
+
+	AndroidUtil::Method_NativeBookModel_setFootnotes->call(javaModel, javaTextModel, ids, javaStarts);
+
+	env->PopLocalFrame(0);
+}
+
+// the first model is the book text model, the second one,
+// if present, contains all the footnotes
+static jint initTextModels(JNIEnv *env, jobject javaModel, const std::vector<BookModelCache::TextModel> &models, const std::vector<BookModel::FootnoteRun> &footnoteRuns) {
+	for (std::size_t i = 0; i < models.size(); ++i) {
+		jobject javaTextModel = createTextModel(env, javaModel, models[i]);
+		if (javaTextModel == 0) {
+			return i == 0 ? 5 : 7;
+		}
+		if (i == 0) {
+			AndroidUtil::Method_NativeBookModel_setBookTextModel->call(javaModel, javaTextModel);
+		} else {
+			setFootnotes(env, javaModel, javaTextModel, footnoteRuns);
+		}
+		if (env->ExceptionCheck()) {
+			return i == 0 ? 6 : 8;
+		}
+		env->DeleteLocalRef(javaTextModel);
+	}
+	return 0;
 }
 
 extern "C"
@@ -273,7 +606,19 @@ JNIEXPORT jint JNICALL Java_org_geometerplus_fbreader_formats_NativeFormatPlugin
 	jobject javaBook = AndroidUtil::Field_NativeBookModel_Book->value(javaModel);
 
 	shared_ptr<Book> book = Book::loadFromJavaBook(env, javaBook);
-	shared_ptr<BookModel> model = new BookModel(book, javaModel);
+	BookModelCache cache(Library::Instance().cacheDirectory(), *book, plugin->supportedFileType());
+	if (cache.load()) {
+		addImages(env, javaModel, cache.images());
+		if (!initInternalHyperlinks(env, javaModel, cache.directory(), cache.linksFileExtension(), cache.linksBlocksNumber())) {
+			return 4;
+		}
+		initTOC(env, javaModel, *cache.contentsTree());
+		return initTextModels(env, javaModel, cache.textModels(), cache.footnoteRuns());
+	}
+	cache.clear();
+
+	shared_ptr<BookModel> model = new BookModel(book, javaModel, cache.directory(), cache.key());
+	model->setPrefixListener(new JavaPrefixListener(env, javaModel, *model), PREFIX_PARAGRAPHS_NUMBER);
 	if (!plugin->readModel(*model)) {
 		return 2;
 	}
@@ -281,38 +626,26 @@ JNIEXPORT jint JNICALL Java_org_geometerplus_fbreader_formats_NativeFormatPlugin
 		AndroidUtil::throwCachedCharStorageException("Cannot write file from native code");
 		return 3;
 	}
+	addNewImages(env, javaModel, *model);
 
-	if (!initInternalHyperlinks(env, javaModel, *model)) {
+	ZLCachedMemoryAllocator linksAllocator(LINKS_ROW_SIZE, model->cacheDirectory(), model->cacheFileExtension("nlinks"));
+	writeInternalHyperlinks(*model, linksAllocator);
+	if (!initInternalHyperlinks(env, javaModel, linksAllocator.directoryName(), linksAllocator.fileExtension(), linksAllocator.blocksNumber())) {
 		return 4;
 	}
 
 	initTOC(env, javaModel, *model->contentsTree());
 
-	shared_ptr<ZLTextModel> textModel = model->bookTextModel();
-	jobject javaTextModel = createTextModel(env, javaModel, *textModel);
-	if (javaTextModel == 0) {
-		return 5;
+	std::vector<BookModelCache::TextModel> textModels;
+	textModels.push_back(BookModelCache::TextModel(*model->bookTextModel()));
+	if (!model->footnotesModel().isNull()) {
+		textModels.push_back(BookModelCache::TextModel(*model->footnotesModel()));
 	}
-	AndroidUtil::Method_NativeBookModel_setBookTextModel->call(javaModel, javaTextModel);
-	if (env->ExceptionCheck()) {
-		return 6;
+	const jint code = initTextModels(env, javaModel, textModels, model->footnoteRuns());
+	if (code == 0 && !linksAllocator.failed() && cache.save(*model, linksAllocator)) {
+		cache.trim();
 	}
-	env->DeleteLocalRef(javaTextModel);
-
-	const std::map<std::string,shared_ptr<ZLTextModel> > &footnotes = model->footnotes();
-	std::map<std::string,shared_ptr<ZLTextModel> >::const_iterator it = footnotes.begin();
-	for (; it != footnotes.end(); ++it) {
-		jobject javaFootnoteModel = createTextModel(env, javaModel, *it->second);
-		if (javaFootnoteModel == 0) {
-			return 7;
-		}
-		AndroidUtil::Method_NativeBookModel_setFootnoteModel->call(javaModel, javaFootnoteModel);
-		if (env->ExceptionCheck()) {
-			return 8;
-		}
-		env->DeleteLocalRef(javaFootnoteModel);
-	}
-	return 0;
+	return code;
 }
 
 extern "C"
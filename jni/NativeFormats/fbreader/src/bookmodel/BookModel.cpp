@@ -27,13 +27,11 @@
 
 #include "../formats/FormatPlugin.h"
 #include "../library/Book.h"
-#include "../library/Library.h"
 
-BookModel::BookModel(const shared_ptr<Book> book, jobject javaModel) : myBook(book) {
+BookModel::BookModel(const shared_ptr<Book> book, jobject javaModel, const std::string &cacheDirectory, const std::string &cacheKey) : myBook(book), myCacheDirectory(cacheDirectory), myCacheKey(cacheKey), myPrefixParagraphsNumber(0) {
 	myJavaModel = AndroidUtil::getEnv()->NewGlobalRef(javaModel);
 
-	const std::string cacheDirectory = Library::Instance().cacheDirectory();
-	myBookTextModel = new ZLTextPlainModel(std::string(), book->language(), 131072, cacheDirectory, "ncache");
+	myBookTextModel = new ZLTextPlainModel(std::string(), book->language(), 131072, cacheDirectory, cacheFileExtension("ncache"));
 	myContentsTree = new ContentsTree();
 	/*shared_ptr<FormatPlugin> plugin = PluginCollection::Instance().plugin(book->file(), false);
 	if (!plugin.isNull()) {
@@ -48,30 +46,114 @@ BookModel::~BookModel() {
 void BookModel::setHyperlinkMatcher(shared_ptr<HyperlinkMatcher> matcher) {
 	myHyperlinkMatcher = matcher;
 }
+
+BookModel::PrefixListener::~PrefixListener() {
+}
+
+void BookModel::setPrefixListener(shared_ptr<PrefixListener> listener, std::size_t paragraphsNumber) {
+	myPrefixListener = listener;
+	myPrefixParagraphsNumber = paragraphsNumber;
+}
+
+void BookModel::checkPrefix() {
+	if (myPrefixListener.isNull() || myBookTextModel->paragraphsNumber() < myPrefixParagraphsNumber) {
+		return;
+	}
+	// writes the current row up to its end; the row is written again when it is complete
+	myBookTextModel->flush();
+	if (!myBookTextModel->allocator().failed()) {
+		myPrefixListener->onPrefixReady(*myBookTextModel);
+	}
+	myPrefixListener = 0;
+}
 	
 BookModel::Label BookModel::label(const std::string &id) const {
 	if (!myHyperlinkMatcher.isNull()) {
 		return myHyperlinkMatcher->match(myInternalHyperlinks, id);
 	}
 
-	std::map<std::string,Label>::const_iterator it = myInternalHyperlinks.find(id);
-	return (it != myInternalHyperlinks.end()) ? it->second : Label(0, -1);
+	const Label *label = myInternalHyperlinks.find(id);
+	return label != 0 ? *label : Label(0, std::string(), -1);
+}
+
+BookModel::LabelMap::LabelMap() : mySlots(1024, 0) {
+}
+
+uint32_t BookModel::LabelMap::hash(const std::string &id) {
+	// FNV-1a
+	uint32_t hash = 2166136261U;
+	for (std::size_t i = 0; i < id.size(); ++i) {
+		hash = (hash ^ (unsigned char)id[i]) * 16777619U;
+	}
+	return hash;
+}
+
+void BookModel::LabelMap::insert(const std::string &id, const Label &label) {
+	const uint32_t idHash = hash(id);
+	const std::size_t mask = mySlots.size() - 1;
+	std::size_t slot = idHash & mask;
+	for (; mySlots[slot] != 0; slot = (slot + 1) & mask) {
+		const std::size_t index = mySlots[slot] - 1;
+		if (myHashes[index] == idHash && myLabels[index].first == id) {
+			return;
+		}
+	}
+
+	myLabels.push_back(std::make_pair(id, label));
+	myHashes.push_back(idHash);
+	mySlots[slot] = myLabels.size();
+	// keeps the load factor under 1/2
+	if (myLabels.size() * 2 > mySlots.size()) {
+		rehash(mySlots.size() * 2);
+	}
+}
+
+const BookModel::Label *BookModel::LabelMap::find(const std::string &id) const {
+	const uint32_t idHash = hash(id);
+	const std::size_t mask = mySlots.size() - 1;
+	for (std::size_t slot = idHash & mask; mySlots[slot] != 0; slot = (slot + 1) & mask) {
+		const std::size_t index = mySlots[slot] - 1;
+		if (myHashes[index] == idHash && myLabels[index].first == id) {
+			return &myLabels[index].second;
+		}
+	}
+	return 0;
+}
+
+void BookModel::LabelMap::rehash(std::size_t slotsNumber) {
+	mySlots.assign(slotsNumber, 0);
+	const std::size_t mask = slotsNumber - 1;
+	for (std::size_t index = 0; index < myHashes.size(); ++index) {
+		std::size_t slot = myHashes[index] & mask;
+		while (mySlots[slot] != 0) {
+			slot = (slot + 1) & mask;
+		}
+		mySlots[slot] = index + 1;
+	}
+}
+
+void BookModel::takeNewImageIds(std::vector<std::string> &ids) {
+	ids.clear();
+	ids.swap(myNewImageIds);
 }
 
 const shared_ptr<Book> BookModel::book() const {
 	return myBook;
 }
 
+std::string BookModel::cacheFileExtension(const std::string &kind) const {
+	return myCacheKey.empty() ? kind : myCacheKey + "." + kind;
+}
+
 bool BookModel::flush() {
 	myBookTextModel->flush();
 	if (myBookTextModel->allocator().failed()) {
 		return false;
 	}
 
-	std::map<std::string,shared_ptr<ZLTextModel> >::const_iterator it = myFootnotes.begin();
-	for (; it != myFootnotes.end(); ++it) {
-		it->second->flush();
-		if (it->second->allocator().failed()) {
+	if (!myFootnotesModel.isNull()) {
+		myFootnotesModel->flush();
+		if (myFootnotesModel->allocator().failed()) {
 			return false;
 		}
 	}
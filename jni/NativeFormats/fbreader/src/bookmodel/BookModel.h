@@ -21,6 +21,7 @@
 #define __BOOKMODEL_H__
 
 #include <jni.h>
+#include <stdint.h>
 
 #include <map>
 #include <vector>
@@ -53,52 +54,132 @@ class BookModel {
 
 public:
 	struct Label {
-		Label(shared_ptr<ZLTextModel> model, int paragraphNumber) : Model(model), ParagraphNumber(paragraphNumber) {}
+		Label(shared_ptr<ZLTextModel> model, const std::string &modelId, int paragraphNumber) : Model(model), ModelId(modelId), ParagraphNumber(paragraphNumber) {}
 
-		const shared_ptr<ZLTextModel> Model;
-		const int ParagraphNumber;
+		shared_ptr<ZLTextModel> Model;
+		// footnote id, empty for the book text model
+		std::string ModelId;
+		// in the footnote for footnote labels
+		int ParagraphNumber;
+	};
+
+	// An open addressing hash table of hyperlink labels; the labels
+	// are kept in the insertion order, the first label for an id wins.
+	class LabelMap {
+
+	public:
+		LabelMap();
+
+		void insert(const std::string &id, const Label &label);
+		// 0 if there is no such label
+		const Label *find(const std::string &id) const;
+
+		std::size_t size() const;
+		const std::string &id(std::size_t index) const;
+		const Label &label(std::size_t index) const;
+
+	private:
+		static uint32_t hash(const std::string &id);
+		void rehash(std::size_t slotsNumber);
+
+	private:
+		std::vector<std::pair<std::string,Label> > myLabels;
+		std::vector<uint32_t> myHashes;
+		// index in myLabels + 1, 0 for an empty slot;
+		// the number of slots is a power of two
+		std::vector<uint32_t> mySlots;
+	};
+
+	// All the footnotes are written into a single text model one after
+	// another. A run is a sequence of paragraphs of a single footnote
+	// that lasts up to the next run; a footnote usually takes one run,
+	// but it may be continued after another one was started.
+	struct FootnoteRun {
+		FootnoteRun(const std::string &id, std::size_t startParagraph) : Id(id), StartParagraph(startParagraph) {}
+
+		std::string Id;
+		std::size_t StartParagraph;
 	};
 
 public:
 	class HyperlinkMatcher {
 
 	public:
-		virtual Label match(const std::map<std::string,Label> &lMap, const std::string &id) const = 0;
+		virtual Label match(const LabelMap &labels, const std::string &id) const = 0;
+	};
+
+	// is notified once, when the book text model has got enough paragraphs
+	// to show the first pages; the parsing goes on after that
+	class PrefixListener {
+
+	public:
+		virtual ~PrefixListener();
+		// all the rows of the model are written before the call
+		virtual void onPrefixReady(const ZLTextModel &model) = 0;
 	};
 
 public:
-	BookModel(const shared_ptr<Book> book, jobject javaModel);
+	// rows are written to cacheDirectory; cacheKey, if not empty,
+	// makes their names unique for the book, see BookModelCache
+	BookModel(const shared_ptr<Book> book, jobject javaModel, const std::string &cacheDirectory, const std::string &cacheKey);
 	~BookModel();
 
 	void setHyperlinkMatcher(shared_ptr<HyperlinkMatcher> matcher);
+	void setPrefixListener(shared_ptr<PrefixListener> listener, std::size_t paragraphsNumber);
 
 	shared_ptr<ZLTextModel> bookTextModel() const;
 	shared_ptr<ContentsTree> contentsTree() const;
-	const std::map<std::string,shared_ptr<ZLTextModel> > &footnotes() const;
+	// null if the book has no footnotes
+	shared_ptr<ZLTextModel> footnotesModel() const;
+	const std::vector<FootnoteRun> &footnoteRuns() const;
+	const std::map<std::string,shared_ptr<const ZLImage> > &images() const;
+	// moves out the ids of the images added since the previous call
+	void takeNewImageIds(std::vector<std::string> &ids);
 
 	Label label(const std::string &id) const;
-	const std::map<std::string,Label> &internalHyperlinks() const;
+	const LabelMap &internalHyperlinks() const;
 
 	const shared_ptr<Book> book() const;
 
+	const std::string &cacheDirectory() const;
+	std::string cacheFileExtension(const std::string &kind) const;
+
 	bool flush();
 
+private:
+	// is called by BookReader before a new paragraph of the book text model
+	void checkPrefix();
+
 private:
 	const shared_ptr<Book> myBook;
 	jobject myJavaModel;
+	const std::string myCacheDirectory;
+	const std::string myCacheKey;
 	shared_ptr<ZLTextModel> myBookTextModel;
 	shared_ptr<ContentsTree> myContentsTree;
-	std::map<std::string,shared_ptr<ZLTextModel> > myFootnotes;
-	std::map<std::string,Label> myInternalHyperlinks;
+	shared_ptr<ZLTextModel> myFootnotesModel;
+	std::vector<FootnoteRun> myFootnoteRuns;
+	std::map<std::string,shared_ptr<const ZLImage> > myImages;
+	std::vector<std::string> myNewImageIds;
+	LabelMap myInternalHyperlinks;
 	shared_ptr<HyperlinkMatcher> myHyperlinkMatcher;
+	shared_ptr<PrefixListener> myPrefixListener;
+	std::size_t myPrefixParagraphsNumber;
 
 friend class BookReader;
 };
 
 inline shared_ptr<ZLTextModel> BookModel::bookTextModel() const { return myBookTextModel; }
 inline shared_ptr<ContentsTree> BookModel::contentsTree() const { return myContentsTree; }
-inline const std::map<std::string,shared_ptr<ZLTextModel> > &BookModel::footnotes() const { return myFootnotes; }
-inline const std::map<std::string,BookModel::Label> &BookModel::internalHyperlinks() const { return myInternalHyperlinks; }
+inline shared_ptr<ZLTextModel> BookModel::footnotesModel() const { return myFootnotesModel; }
+inline const std::vector<BookModel::FootnoteRun> &BookModel::footnoteRuns() const { return myFootnoteRuns; }
+inline const std::map<std::string,shared_ptr<const ZLImage> > &BookModel::images() const { return myImages; }
+inline const BookModel::LabelMap &BookModel::internalHyperlinks() const { return myInternalHyperlinks; }
+
+inline std::size_t BookModel::LabelMap::size() const { return myLabels.size(); }
+inline const std::string &BookModel::LabelMap::id(std::size_t index) const { return myLabels[index].first; }
+inline const BookModel::Label &BookModel::LabelMap::label(std::size_t index) const { return myLabels[index].second; }
+inline const std::string &BookModel::cacheDirectory() const { return myCacheDirectory; }
 
 inline ContentsTree::ContentsTree() : myReference(-1) {}
 inline ContentsTree::ContentsTree(ContentsTree &parent, int reference) : myReference(reference) {
@@ -0,0 +1,554 @@
+/*
+ * Copyright (C) 2004-2014 Geometer Plus <contact@geometerplus.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <utime.h>
+#include <zlib.h>
+
+#include <cstring>
+
+#include <algorithm>
+
+#include <ZLFile.h>
+#include <ZLDir.h>
+#include <ZLInputStream.h>
+#include <ZLOutputStream.h>
+#include <ZLFileImage.h>
+#include <ZLStringUtil.h>
+#include <ZLTextModel.h>
+#include <ZLCachedMemoryAllocator.h>
+
+#include "BookModelCache.h"
+#include "BookModel.h"
+
+#include "../library/Book.h"
+
+static const char MANIFEST_MAGIC[4] = { 'F', 'B', 'M', 'C' };
+// must be changed with any change of the manifest or of the row format
+static const uint32_t MANIFEST_VERSION = 3;
+// the book is identified by checksums of its first and last blocks
+static const std::size_t HASHED_BLOCK_SIZE = 65536;
+// entries are removed when the cache grows larger than this
+static const std::size_t CACHE_SIZE_LIMIT = 64 * 1024 * 1024;
+
+static void writeUInt32(std::string &data, uint32_t value) {
+	data.append((const char*)&value, 4);
+}
+
+// all the data is aligned to 4 bytes, so the arrays can be used in place
+static void writeData(std::string &data, const void *ptr, std::size_t size) {
+	writeUInt32(data, size);
+	data.append((const char*)ptr, size);
+	data.append((4 - size % 4) % 4, '\0');
+}
+
+static void writeString(std::string &data, const std::string &str) {
+	writeData(data, str.data(), str.size());
+}
+
+static void writeContentsTree(std::string &data, const ContentsTree &tree) {
+	const std::vector<shared_ptr<ContentsTree> > &children = tree.children();
+	writeUInt32(data, children.size());
+	for (std::vector<shared_ptr<ContentsTree> >::const_iterator it = children.begin(); it != children.end(); ++it) {
+		writeString(data, (*it)->text());
+		writeUInt32(data, (uint32_t)(*it)->reference());
+		writeContentsTree(data, **it);
+	}
+}
+
+class ManifestReader {
+
+public:
+	ManifestReader(const char *data, std::size_t size);
+
+	bool failed() const;
+	bool atEnd() const;
+
+	uint32_t readUInt32();
+	// returns 0 if the stored size differs from expectedSize
+	const char *readData(std::size_t expectedSize);
+	std::string readString();
+
+private:
+	const char *readData(std::size_t &size, bool sizeIsKnown);
+
+private:
+	const char *myPtr;
+	const char *const myEnd;
+	bool myFailed;
+};
+
+ManifestReader::ManifestReader(const char *data, std::size_t size) : myPtr(data), myEnd(data + size), myFailed(false) {
+}
+
+bool ManifestReader::failed() const {
+	return myFailed;
+}
+
+bool ManifestReader::atEnd() const {
+	return myPtr == myEnd;
+}
+
+uint32_t ManifestReader::readUInt32() {
+	if (myFailed || myEnd - myPtr < 4) {
+		myFailed = true;
+		return 0;
+	}
+	const uint32_t value = *(const uint32_t*)myPtr;
+	myPtr += 4;
+	return value;
+}
+
+const char *ManifestReader::readData(std::size_t expectedSize) {
+	return readData(expectedSize, true);
+}
+
+std::string ManifestReader::readString() {
+	std::size_t size;
+	const char *data = readData(size, false);
+	return data != 0 ? std::string(data, size) : std::string();
+}
+
+const char *ManifestReader::readData(std::size_t &size, bool sizeIsKnown) {
+	const std::size_t storedSize = readUInt32();
+	if (myFailed || (sizeIsKnown && storedSize != size)) {
+		myFailed = true;
+		return 0;
+	}
+	const std::size_t alignedSize = (storedSize + 3) & ~(std::size_t)3;
+	if ((std::size_t)(myEnd - myPtr) < alignedSize) {
+		myFailed = true;
+		return 0;
+	}
+	const char *data = myPtr;
+	myPtr += alignedSize;
+	size = storedSize;
+	return data;
+}
+
+static bool readContentsTree(ManifestReader &reader, ContentsTree &tree) {
+	const std::size_t count = reader.readUInt32();
+	for (std::size_t i = 0; i < count && !reader.failed(); ++i) {
+		const std::string text = reader.readString();
+		const int reference = (int)reader.readUInt32();
+		if (reader.failed()) {
+			break;
+		}
+		// is owned by the parent
+		ContentsTree *child = new ContentsTree(tree, reference);
+		child->addText(text);
+		if (!readContentsTree(reader, *child)) {
+			break;
+		}
+	}
+	return !reader.failed();
+}
+
+// the second component of "<index>.<key>.<kind>" and of "manifest.<key>"
+static std::string entryKey(const std::string &fileName) {
+	const std::size_t start = fileName.find('.');
+	if (start == std::string::npos) {
+		return std::string();
+	}
+	const std::size_t end = fileName.find('.', start + 1);
+	return fileName.substr(start + 1, end == std::string::npos ? std::string::npos : end - start - 1);
+}
+
+struct CacheEntry {
+	CacheEntry() : Size(0), LastUsed(0) {}
+
+	std::size_t Size;
+	// is 0 for entries without a manifest, they go first
+	long LastUsed;
+	// the manifest, if any, goes first
+	std::vector<std::string> Files;
+};
+
+static uLong blockChecksum(ZLInputStream &stream, std::string &buffer) {
+	const std::size_t length = stream.read(&buffer[0], buffer.size());
+	return crc32(0, (const Bytef*)buffer.data(), length);
+}
+
+BookModelCache::TextModel::TextModel() :
+	ParagraphsNumber(0),
+	ArraysSize(0),
+	StartEntryIndices(0),
+	StartEntryOffsets(0),
+	ParagraphLengths(0),
+	TextSizes(0),
+	ParagraphKinds(0),
+	StyleTable(0),
+	StyleTableSize(0),
+	BlocksNumber(0) {
+}
+
+BookModelCache::TextModel::TextModel(const ZLTextModel &model) :
+	Id(model.id()),
+	Language(model.language()),
+	ParagraphsNumber(model.paragraphsNumber()),
+	ArraysSize(model.paragraphsNumber()),
+	StartEntryIndices(model.startEntryIndices()),
+	StartEntryOffsets(model.startEntryOffsets()),
+	ParagraphLengths(model.paragraphLengths()),
+	TextSizes(model.textSizes()),
+	ParagraphKinds(model.paragraphKinds()),
+	StyleTable((const jchar*)model.styleTable().data()),
+	StyleTableSize(model.styleTable().size() / 2),
+	DirectoryName(model.allocator().directoryName()),
+	FileExtension(model.allocator().fileExtension()),
+	BlocksNumber(model.allocator().blocksNumber()) {
+}
+
+BookModelCache::BookModelCache(const std::string &cacheDirectory, const Book &book, const std::string &pluginType) : myDirectory(cacheDirectory), myLinksBlocksNumber(0) {
+	const ZLFile physicalFile(book.file().physicalFilePath());
+	shared_ptr<ZLInputStream> stream = physicalFile.inputStream();
+	if (stream.isNull() || !stream->open()) {
+		return;
+	}
+	const std::size_t size = physicalFile.size();
+	std::string buffer(HASHED_BLOCK_SIZE, '\0');
+	const uLong headChecksum = blockChecksum(*stream, buffer);
+	uLong tailChecksum = 0;
+	// seeking in a compressed stream means unpacking it
+	if (size > HASHED_BLOCK_SIZE && !physicalFile.isCompressed()) {
+		stream->seek(size - HASHED_BLOCK_SIZE, true);
+		tailChecksum = blockChecksum(*stream, buffer);
+	}
+	stream->close();
+
+	myIdentity = pluginType;
+	myIdentity += '\n';
+	myIdentity += book.file().path();
+	myIdentity += '\n';
+	ZLStringUtil::appendNumber(myIdentity, size);
+	myIdentity += '\n';
+	ZLStringUtil::appendNumber(myIdentity, physicalFile.lastModified());
+	myIdentity += '\n';
+	ZLStringUtil::appendNumber(myIdentity, headChecksum);
+	myIdentity += '\n';
+	ZLStringUtil::appendNumber(myIdentity, tailChecksum);
+	myIdentity += '\n';
+	myIdentity += book.encoding();
+	myIdentity += '\n';
+	myIdentity += book.language();
+
+	// different books can share a key; the identity is checked by load()
+	ZLStringUtil::appendNumber(myKey, crc32(0, (const Bytef*)myIdentity.data(), myIdentity.size()));
+	myDirectory += "/models";
+}
+
+BookModelCache::~BookModelCache() {
+	if (!myManifestStream.isNull()) {
+		myManifestStream->close();
+	}
+}
+
+std::string BookModelCache::rowFileName(const std::string &extension, std::size_t index) const {
+	std::string name;
+	ZLStringUtil::appendNumber(name, index);
+	return name.append(".").append(extension);
+}
+
+std::string BookModelCache::manifestFileName() const {
+	return myDirectory + "/manifest." + myKey;
+}
+
+bool BookModelCache::load() {
+	if (!isEnabled()) {
+		return false;
+	}
+	const std::string fileName = manifestFileName();
+	// the manifest is replaced by rename only, so it can be mapped
+	myManifestStream = ZLFile(fileName).mappedInputStream();
+	if (myManifestStream.isNull() || !myManifestStream->open()) {
+		myManifestStream = 0;
+		return false;
+	}
+
+	const std::size_t size = myManifestStream->sizeOfOpened();
+	std::size_t available;
+	const char *data = myManifestStream->borrow(available);
+	if (data == 0 || available < size) {
+		myManifestBuffer.assign(size, '\0');
+		if (size == 0 || myManifestStream->read(&myManifestBuffer[0], size) != size) {
+			myManifestStream->close();
+			myManifestStream = 0;
+			return false;
+		}
+		data = myManifestBuffer.data();
+	}
+
+	if (!readManifest(data, size)) {
+		myTextModels.clear();
+		myFootnoteRuns.clear();
+		myContentsTree = 0;
+		myImages.clear();
+		myManifestStream->close();
+		myManifestStream = 0;
+		myManifestBuffer.clear();
+		return false;
+	}
+
+	// the modification time orders entries for trim()
+	utime(fileName.c_str(), 0);
+	return true;
+}
+
+bool BookModelCache::readManifest(const char *data, std::size_t size) {
+	if (size < 12 || size % 4 != 0 || std::memcmp(data, MANIFEST_MAGIC, 4) != 0) {
+		return false;
+	}
+	const uint32_t checksum = *(const uint32_t*)(data + size - 4);
+	if (checksum != crc32(0, (const Bytef*)data, size - 4)) {
+		return false;
+	}
+
+	ManifestReader reader(data + 4, size - 8);
+	if (reader.readUInt32() != MANIFEST_VERSION || reader.readString() != myIdentity) {
+		return false;
+	}
+
+	// rows are not checksummed, reading them all would cost
+	// about as much as parsing; a truncated row is detected by its size
+	const std::size_t filesNumber = reader.readUInt32();
+	for (std::size_t i = 0; i < filesNumber && !reader.failed(); ++i) {
+		const ZLFile file(myDirectory + "/" + reader.readString());
+		const std::size_t fileSize = reader.readUInt32();
+		if (!file.exists() || file.size() != fileSize) {
+			return false;
+		}
+	}
+
+	myLinksFileExtension = reader.readString();
+	myLinksBlocksNumber = reader.readUInt32();
+
+	const std::size_t modelsNumber = reader.readUInt32();
+	for (std::size_t i = 0; i < modelsNumber && !reader.failed(); ++i) {
+		myTextModels.push_back(TextModel());
+		TextModel &model = myTextModels.back();
+		model.Id = reader.readString();
+		model.Language = reader.readString();
+		model.ParagraphsNumber = reader.readUInt32();
+		model.ArraysSize = reader.readUInt32();
+		const std::size_t arraysSize = model.ArraysSize;
+		model.StartEntryIndices = (const jint*)reader.readData(arraysSize * sizeof(jint));
+		model.StartEntryOffsets = (const jint*)reader.readData(arraysSize * sizeof(jint));
+		model.ParagraphLengths = (const jint*)reader.readData(arraysSize * sizeof(jint));
+		model.TextSizes = (const jint*)reader.readData(arraysSize * sizeof(jint));
+		model.ParagraphKinds = (const jbyte*)reader.readData(arraysSize);
+		model.StyleTableSize = reader.readUInt32();
+		model.StyleTable = (const jchar*)reader.readData(model.StyleTableSize * sizeof(jchar));
+		model.DirectoryName = myDirectory;
+		model.FileExtension = reader.readString();
+		model.BlocksNumber = reader.readUInt32();
+	}
+
+	const std::size_t runsNumber = reader.readUInt32();
+	for (std::size_t i = 0; i < runsNumber && !reader.failed(); ++i) {
+		const std::string id = reader.readString();
+		myFootnoteRuns.push_back(BookModel::FootnoteRun(id, reader.readUInt32()));
+	}
+
+	myContentsTree = new ContentsTree();
+	if (!readContentsTree(reader, *myContentsTree)) {
+		return false;
+	}
+
+	const std::size_t imagesNumber = reader.readUInt32();
+	for (std::size_t i = 0; i < imagesNumber && !reader.failed(); ++i) {
+		const std::string id = reader.readString();
+		const std::string path = reader.readString();
+		const std::string mimeType = reader.readString();
+		const std::string encoding = reader.readString();
+		ZLFileImage::Blocks blocks;
+		const std::size_t blocksNumber = reader.readUInt32();
+		for (std::size_t j = 0; j < blocksNumber && !reader.failed(); ++j) {
+			const unsigned int offset = reader.readUInt32();
+			blocks.push_back(ZLFileImage::Block(offset, reader.readUInt32()));
+		}
+		myImages[id] = new ZLFileImage(ZLFile(path, mimeType), encoding, blocks);
+	}
+
+	return !reader.failed() && reader.atEnd() && !myTextModels.empty();
+}
+
+void BookModelCache::clear() {
+	if (!isEnabled()) {
+		return;
+	}
+	shared_ptr<ZLDir> dir = ZLFile(myDirectory).directory();
+	if (dir.isNull()) {
+		return;
+	}
+	// the manifest goes first, so a partially removed entry is never used
+	ZLFile(manifestFileName()).remove();
+	std::vector<std::string> names;
+	dir->collectFiles(names, false);
+	for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it) {
+		if (entryKey(*it) == myKey) {
+			ZLFile(dir->itemPath(*it)).remove();
+		}
+	}
+}
+
+bool BookModelCache::save(const BookModel &model, const ZLCachedMemoryAllocator &links) {
+	if (!isEnabled()) {
+		return false;
+	}
+
+	std::vector<TextModel> textModels;
+	textModels.push_back(TextModel(*model.bookTextModel()));
+	if (!model.footnotesModel().isNull()) {
+		textModels.push_back(TextModel(*model.footnotesModel()));
+	}
+
+	// extension -> number of rows
+	std::map<std::string,std::size_t> rows;
+	rows[links.fileExtension()] = links.blocksNumber();
+	for (std::vector<TextModel>::const_iterator it = textModels.begin(); it != textModels.end(); ++it) {
+		rows[it->FileExtension] = it->BlocksNumber;
+	}
+
+	std::string data(MANIFEST_MAGIC, 4);
+	writeUInt32(data, MANIFEST_VERSION);
+	writeString(data, myIdentity);
+
+	std::size_t filesNumber = 0;
+	for (std::map<std::string,std::size_t>::const_iterator it = rows.begin(); it != rows.end(); ++it) {
+		filesNumber += it->second;
+	}
+	writeUInt32(data, filesNumber);
+	for (std::map<std::string,std::size_t>::const_iterator it = rows.begin(); it != rows.end(); ++it) {
+		for (std::size_t i = 0; i < it->second; ++i) {
+			const std::string name = rowFileName(it->first, i);
+			const ZLFile file(myDirectory + "/" + name);
+			if (!file.exists()) {
+				return false;
+			}
+			writeString(data, name);
+			writeUInt32(data, file.size());
+		}
+	}
+
+	writeString(data, links.fileExtension());
+	writeUInt32(data, links.blocksNumber());
+
+	writeUInt32(data, textModels.size());
+	for (std::vector<TextModel>::const_iterator it = textModels.begin(); it != textModels.end(); ++it) {
+		writeString(data, it->Id);
+		writeString(data, it->Language);
+		writeUInt32(data, it->ParagraphsNumber);
+		writeUInt32(data, it->ArraysSize);
+		writeData(data, it->StartEntryIndices, it->ArraysSize * sizeof(jint));
+		writeData(data, it->StartEntryOffsets, it->ArraysSize * sizeof(jint));
+		writeData(data, it->ParagraphLengths, it->ArraysSize * sizeof(jint));
+		writeData(data, it->TextSizes, it->ArraysSize * sizeof(jint));
+		writeData(data, it->ParagraphKinds, it->ArraysSize);
+		writeUInt32(data, it->StyleTableSize);
+		writeData(data, it->StyleTable, it->StyleTableSize * sizeof(jchar));
+		writeString(data, it->FileExtension);
+		writeUInt32(data, it->BlocksNumber);
+	}
+
+	const std::vector<BookModel::FootnoteRun> &runs = model.footnoteRuns();
+	writeUInt32(data, runs.size());
+	for (std::vector<BookModel::FootnoteRun>::const_iterator it = runs.begin(); it != runs.end(); ++it) {
+		writeString(data, it->Id);
+		writeUInt32(data, it->StartParagraph);
+	}
+
+	writeContentsTree(data, *model.contentsTree());
+
+	const std::map<std::string,shared_ptr<const ZLImage> > &images = model.images();
+	writeUInt32(data, images.size());
+	for (std::map<std::string,shared_ptr<const ZLImage> >::const_iterator it = images.begin(); it != images.end(); ++it) {
+		const ZLFileImage &image = (const ZLFileImage&)*it->second;
+		writeString(data, it->first);
+		writeString(data, image.file().path());
+		writeString(data, image.mimeType());
+		writeString(data, image.encoding());
+		const ZLFileImage::Blocks &blocks = image.blocks();
+		writeUInt32(data, blocks.size());
+		for (ZLFileImage::Blocks::const_iterator jt = blocks.begin(); jt != blocks.end(); ++jt) {
+			writeUInt32(data, jt->offset);
+			writeUInt32(data, jt->size);
+		}
+	}
+
+	writeUInt32(data, crc32(0, (const Bytef*)data.data(), data.size()));
+
+	// the stream writes a temporary file and renames it on close
+	shared_ptr<ZLOutputStream> stream = ZLFile(manifestFileName()).outputStream();
+	if (stream.isNull() || !stream->open()) {
+		return false;
+	}
+	stream->write(data);
+	stream->close();
+	return true;
+}
+
+void BookModelCache::trim() {
+	if (!isEnabled()) {
+		return;
+	}
+	shared_ptr<ZLDir> dir = ZLFile(myDirectory).directory();
+	if (dir.isNull()) {
+		return;
+	}
+
+	std::map<std::string,CacheEntry> entries;
+	std::size_t totalSize = 0;
+
+	std::vector<std::string> names;
+	dir->collectFiles(names, false);
+	for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it) {
+		const std::string key = entryKey(*it);
+		if (key.empty()) {
+			continue;
+		}
+		const ZLFile file(dir->itemPath(*it));
+		CacheEntry &entry = entries[key];
+		entry.Size += file.size();
+		if (*it == "manifest." + key) {
+			entry.LastUsed = file.lastModified();
+			entry.Files.insert(entry.Files.begin(), file.path());
+		} else {
+			entry.Files.push_back(file.path());
+		}
+		totalSize += file.size();
+	}
+	if (totalSize <= CACHE_SIZE_LIMIT) {
+		return;
+	}
+
+	std::vector<std::pair<long,std::string> > order;
+	for (std::map<std::string,CacheEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+		if (it->first != myKey) {
+			order.push_back(std::make_pair(it->second.LastUsed, it->first));
+		}
+	}
+	std::sort(order.begin(), order.end());
+
+	for (std::vector<std::pair<long,std::string> >::const_iterator it = order.begin(); it != order.end() && totalSize > CACHE_SIZE_LIMIT; ++it) {
+		const CacheEntry &entry = entries[it->second];
+		for (std::vector<std::string>::const_iterator jt = entry.Files.begin(); jt != entry.Files.end(); ++jt) {
+			ZLFile(*jt).remove();
+		}
+		totalSize -= entry.Size;
+	}
+}
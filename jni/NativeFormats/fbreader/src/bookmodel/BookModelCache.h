@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2004-2014 Geometer Plus <contact@geometerplus.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef __BOOKMODELCACHE_H__
+#define __BOOKMODELCACHE_H__
+
+#include <jni.h>
+
+#include <map>
+#include <vector>
+#include <string>
+
+#include <shared_ptr.h>
+
+#include "BookModel.h"
+
+class Book;
+class ZLImage;
+class ZLInputStream;
+class ZLTextModel;
+class ZLCachedMemoryAllocator;
+
+// Keeps parsed models between book openings. An entry consists of the row
+// files written by the model allocators and of a manifest holding all the
+// rest (paragraph arrays, style tables, contents tree, images); the manifest
+// is written last, so an entry without it is never used.
+// All the files live in a single directory: rows are named
+// "<index>.<key>.<kind>", the manifest is named "manifest.<key>".
+class BookModelCache {
+
+public:
+	// paragraph arrays of a text model; point either into
+	// a ZLTextModel or into the mapped manifest
+	struct TextModel {
+		TextModel();
+		TextModel(const ZLTextModel &model);
+
+		std::string Id;
+		std::string Language;
+		std::size_t ParagraphsNumber;
+		std::size_t ArraysSize;
+		const jint *StartEntryIndices;
+		const jint *StartEntryOffsets;
+		const jint *ParagraphLengths;
+		const jint *TextSizes;
+		const jbyte *ParagraphKinds;
+		// UTF-16 code units
+		const jchar *StyleTable;
+		std::size_t StyleTableSize;
+		std::string DirectoryName;
+		std::string FileExtension;
+		std::size_t BlocksNumber;
+	};
+
+public:
+	BookModelCache(const std::string &cacheDirectory, const Book &book, const std::string &pluginType);
+	~BookModelCache();
+
+	// the cache is disabled for books that are not local files;
+	// their models are written to cacheDirectory as before
+	bool isEnabled() const;
+	const std::string &directory() const;
+	const std::string &key() const;
+
+	// maps the manifest of the entry; fails if there is no entry,
+	// or it is corrupted, or it was written for another file
+	bool load();
+	// the following are valid after a successful load()
+	// the book text model, then the footnotes model if any
+	const std::vector<TextModel> &textModels() const;
+	const std::vector<BookModel::FootnoteRun> &footnoteRuns() const;
+	shared_ptr<ContentsTree> contentsTree() const;
+	const std::map<std::string,shared_ptr<const ZLImage> > &images() const;
+	const std::string &linksFileExtension() const;
+	std::size_t linksBlocksNumber() const;
+
+	// removes all the files of the entry
+	void clear();
+	// is called after the model and the links rows are flushed
+	bool save(const BookModel &model, const ZLCachedMemoryAllocator &links);
+	// removes least recently used entries other than this one
+	// while the cache is larger than the budget
+	void trim();
+
+private:
+	bool readManifest(const char *data, std::size_t size);
+	std::string rowFileName(const std::string &extension, std::size_t index) const;
+	std::string manifestFileName() const;
+
+private:
+	std::string myDirectory;
+	std::string myKey;
+	// file size, mtime, head and tail checksums, etc.
+	std::string myIdentity;
+
+	shared_ptr<ZLInputStream> myManifestStream;
+	std::string myManifestBuffer;
+	std::vector<TextModel> myTextModels;
+	std::vector<BookModel::FootnoteRun> myFootnoteRuns;
+	shared_ptr<ContentsTree> myContentsTree;
+	std::map<std::string,shared_ptr<const ZLImage> > myImages;
+	std::string myLinksFileExtension;
+	std::size_t myLinksBlocksNumber;
+
+private:
+	BookModelCache(const BookModelCache&);
+	const BookModelCache &operator = (const BookModelCache&);
+};
+
+inline bool BookModelCache::isEnabled() const { return !myKey.empty(); }
+inline const std::string &BookModelCache::directory() const { return myDirectory; }
+inline const std::string &BookModelCache::key() const { return myKey; }
+inline const std::vector<BookModelCache::TextModel> &BookModelCache::textModels() const { return myTextModels; }
+inline const std::vector<BookModel::FootnoteRun> &BookModelCache::footnoteRuns() const { return myFootnoteRuns; }
+inline shared_ptr<ContentsTree> BookModelCache::contentsTree() const { return myContentsTree; }
+inline const std::map<std::string,shared_ptr<const ZLImage> > &BookModelCache::images() const { return myImages; }
+inline const std::string &BookModelCache::linksFileExtension() const { return myLinksFileExtension; }
+inline std::size_t BookModelCache::linksBlocksNumber() const { return myLinksBlocksNumber; }
+
+#endif /* __BOOKMODELCACHE_H__ */
@@ -17,11 +17,7 @@
  * 02110-1301, USA.
  */
 
-#include <AndroidUtil.h>
-#include <JniEnvelope.h>
-
 #include <ZLImage.h>
-#include <ZLFileImage.h>
 #include <ZLLogger.h>
 #include <ZLCachedMemoryAllocator.h>
 #include <ZLTextStyleEntry.h>
@@ -30,7 +26,6 @@
 #include "BookModel.h"
 
 #include "../library/Book.h"
-#include "../library/Library.h"
 
 BookReader::BookReader(BookModel &model) : myModel(model) {
 	myCurrentTextModel = 0;
@@ -47,16 +42,24 @@ void BookReader::setMainTextModel() {
 }
 
 void BookReader::setFootnoteTextModel(const std::string &id) {
-	std::map<std::string,shared_ptr<ZLTextModel> >::iterator it = myModel.myFootnotes.find(id);
-	if (it != myModel.myFootnotes.end()) {
-		myCurrentTextModel = (*it).second;
-	} else {
-		if (myFootnotesAllocator.isNull()) {
-			myFootnotesAllocator = new ZLCachedMemoryAllocator(8192, Library::Instance().cacheDirectory(), "footnotes");
+	shared_ptr<ZLTextModel> &footnotes = myModel.myFootnotesModel;
+	if (footnotes.isNull()) {
+		footnotes = new ZLTextPlainModel(std::string(), myModel.myBookTextModel->language(), 8192, myModel.cacheDirectory(), myModel.cacheFileExtension("footnotes"));
+	}
+	myCurrentTextModel = footnotes;
+
+	std::vector<BookModel::FootnoteRun> &runs = myModel.myFootnoteRuns;
+	if (!runs.empty()) {
+		const BookModel::FootnoteRun &last = runs.back();
+		if (last.Id == id) {
+			return;
+		}
+		const std::size_t length = footnotes->paragraphsNumber() - last.StartParagraph;
+		if (length > 0) {
+			myFootnoteOffsets[last.Id] += length;
 		}
-		myCurrentTextModel = new ZLTextPlainModel(id, myModel.myBookTextModel->language(), myFootnotesAllocator);
-		myModel.myFootnotes.insert(std::make_pair(id, myCurrentTextModel));
 	}
+	runs.push_back(BookModel::FootnoteRun(id, footnotes->paragraphsNumber()));
 }
 
 bool BookReader::paragraphIsOpen() const {
@@ -94,6 +97,9 @@ bool BookReader::isKindStackEmpty() const {
 void BookReader::beginParagraph(ZLTextParagraph::Kind kind) {
 	endParagraph();
 	if (myCurrentTextModel != 0) {
+		if (myCurrentTextModel == myModel.myBookTextModel) {
+			myModel.checkPrefix();
+		}
 		((ZLTextPlainModel&)*myCurrentTextModel).createParagraph(kind);
 		for (std::vector<FBTextKind>::const_iterator it = myKindStack.begin(); it != myKindStack.end(); ++it) {
 			myCurrentTextModel->addControl(*it, true);
@@ -145,7 +151,7 @@ void BookReader::addFixedHSpace(unsigned char length) {
 
 void BookReader::addHyperlinkControl(FBTextKind kind, const std::string &label) {
 	myHyperlinkKind = kind;
-	std::string type;
+	const char *type = "";
 	switch (myHyperlinkKind) {
 		case INTERNAL_HYPERLINK:
 		case FOOTNOTE:
@@ -164,9 +170,9 @@ void BookReader::addHyperlinkControl(FBTextKind kind, const std::string &label)
 			myHyperlinkType = HYPERLINK_NONE;
 			break;
 	}
-	ZLLogger::Instance().println(
+	ZLLOG_DEBUG(
 		"hyperlink",
-		" + control (" + type + "): " + label
+		std::string(" + control (") + type + "): " + label
 	);
 	if (paragraphIsOpen()) {
 		flushTextBufferToParagraph();
@@ -176,23 +182,41 @@ void BookReader::addHyperlinkControl(FBTextKind kind, const std::string &label)
 }
 
 void BookReader::addHyperlinkLabel(const std::string &label) {
-	if (!myCurrentTextModel.isNull()) {
+	if (myCurrentTextModel.isNull()) {
+		return;
+	}
+	if (myCurrentTextModel != myModel.myFootnotesModel) {
 		int paragraphNumber = myCurrentTextModel->paragraphsNumber();
 		if (paragraphIsOpen()) {
 			--paragraphNumber;
 		}
 		addHyperlinkLabel(label, paragraphNumber);
+		return;
+	}
+
+	// counted from the footnote start; an open paragraph
+	// started before the last run belongs to another footnote
+	const BookModel::FootnoteRun &run = myModel.myFootnoteRuns.back();
+	std::size_t paragraphNumber = myCurrentTextModel->paragraphsNumber() - run.StartParagraph;
+	if (paragraphIsOpen() && paragraphNumber > 0) {
+		--paragraphNumber;
+	}
+	std::map<std::string,std::size_t>::const_iterator it = myFootnoteOffsets.find(run.Id);
+	if (it != myFootnoteOffsets.end()) {
+		paragraphNumber += it->second;
 	}
+	addHyperlinkLabel(label, paragraphNumber);
 }
 
 void BookReader::addHyperlinkLabel(const std::string &label, int paragraphNumber) {
-	ZLLogger::Instance().println(
+	ZLLOG_DEBUG(
 		"hyperlink",
 		" + label: " + label
 	);
-	myModel.myInternalHyperlinks.insert(std::make_pair(
-		label, BookModel::Label(myCurrentTextModel, paragraphNumber)
-	));
+	const bool isFootnote = !myCurrentTextModel.isNull() && myCurrentTextModel == myModel.myFootnotesModel;
+	myModel.myInternalHyperlinks.insert(
+		label, BookModel::Label(myCurrentTextModel, isFootnote ? myModel.myFootnoteRuns.back().Id : std::string(), paragraphNumber)
+	);
 }
 
 void BookReader::addData(const std::string &data) {
@@ -220,20 +244,15 @@ void BookReader::addImage(const std::string &id, shared_ptr<const ZLImage> image
 		return;
 	}
 
-	JNIEnv *env = AndroidUtil::getEnv();
-
-	jobject javaImage = AndroidUtil::createJavaImage(env, (const ZLFileImage&)*image);
-	jstring javaId = AndroidUtil::createJavaString(env, id);
-	AndroidUtil::Method_NativeBookModel_addImage->call(myModel.myJavaModel, javaId, javaImage);
-
-	env->DeleteLocalRef(javaId);
-	env->DeleteLocalRef(javaImage);
+	myModel.myImages[id] = image;
+	// the images are passed to Java in batches, see BookModel::takeNewImageIds()
+	myModel.myNewImageIds.push_back(id);
 }
 
 void BookReader::insertEndParagraph(ZLTextParagraph::Kind kind) {
 	if (myCurrentTextModel != 0 && mySectionContainsRegularContents) {
 		std::size_t size = myCurrentTextModel->paragraphsNumber();
-		if ((size > 0) && (((*myCurrentTextModel)[(std::size_t)-1])->kind() != kind)) {
+		if ((size > 0) && ((*myCurrentTextModel)[(std::size_t)-1].kind() != kind)) {
 			endParagraph();
 			((ZLTextPlainModel&)*myCurrentTextModel).createParagraph(kind);
 			mySectionContainsRegularContents = false;
@@ -21,6 +21,7 @@
 #define __BOOKREADER_H__
 
 #include <vector>
+#include <map>
 #include <list>
 #include <stack>
 #include <string>
@@ -34,7 +35,6 @@ class BookModel;
 class ContentsTree;
 class ZLTextModel;
 class ZLInputStream;
-class ZLCachedMemoryAllocator;
 class ZLTextStyleEntry;
 
 class BookReader {
@@ -106,7 +106,9 @@ private:
 	FBHyperlinkType myHyperlinkType;
 	FBTextKind myHyperlinkKind;
 
-	shared_ptr<ZLCachedMemoryAllocator> myFootnotesAllocator;
+	// footnote id -> number of paragraphs in its runs before the last one,
+	// see BookModel::FootnoteRun
+	std::map<std::string,std::size_t> myFootnoteOffsets;
 };
 
 inline bool BookReader::contentsParagraphIsOpen() const {
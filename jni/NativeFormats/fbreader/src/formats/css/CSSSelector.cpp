@@ -0,0 +1,293 @@
+/*
+ * Copyright (C) 2004-2014 Geometer Plus <contact@geometerplus.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <algorithm>
+
+#include <ZLStringUtil.h>
+
+#include "CSSSelector.h"
+
+static bool isSpace(char ch) {
+	return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' || ch == '\f';
+}
+
+static bool isNameChar(char ch) {
+	return
+		(ch >= 'a' && ch <= 'z') ||
+		(ch >= 'A' && ch <= 'Z') ||
+		(ch >= '0' && ch <= '9') ||
+		ch == '-' || ch == '_' || (ch & 0x80) != 0;
+}
+
+static void skipSpaces(const std::string &text, std::size_t &index) {
+	while (index < text.length() && isSpace(text[index])) {
+		++index;
+	}
+}
+
+static std::string readName(const std::string &text, std::size_t &index) {
+	std::string name;
+	while (index < text.length()) {
+		const char ch = text[index];
+		if (isNameChar(ch)) {
+			name += ch;
+			++index;
+		} else if (ch == '\\' && index + 1 < text.length()) {
+			name += text[index + 1];
+			index += 2;
+		} else {
+			break;
+		}
+	}
+	return name;
+}
+
+static void toLowerAscii(std::string &str) {
+	for (std::string::iterator it = str.begin(); it != str.end(); ++it) {
+		if (*it >= 'A' && *it <= 'Z') {
+			*it += 'a' - 'A';
+		}
+	}
+}
+
+shared_ptr<CSSSelector> CSSSelector::parse(const std::string &text) {
+	shared_ptr<CSSSelector> selector = new CSSSelector();
+	std::vector<Compound> compounds;
+
+	std::size_t index = 0;
+	skipSpaces(text, index);
+	Compound::Combinator relation = Compound::NONE;
+	while (true) {
+		compounds.push_back(Compound());
+		Compound &compound = compounds.back();
+		compound.Relation = relation;
+
+		bool hasStar = false;
+		if (index < text.length() && text[index] == '*') {
+			hasStar = true;
+			++index;
+		} else {
+			compound.Tag = readName(text, index);
+			toLowerAscii(compound.Tag);
+		}
+		while (index < text.length()) {
+			const char ch = text[index];
+			if (ch == '#') {
+				++index;
+				compound.Id = readName(text, index);
+				if (compound.Id.empty()) {
+					return 0;
+				}
+			} else if (ch == '.') {
+				++index;
+				compound.Classes.push_back(readName(text, index));
+				if (compound.Classes.back().empty()) {
+					return 0;
+				}
+			} else if (ch == '[') {
+				++index;
+				skipSpaces(text, index);
+				Condition condition;
+				condition.Name = readName(text, index);
+				toLowerAscii(condition.Name);
+				skipSpaces(text, index);
+				if (condition.Name.empty() || index >= text.length()) {
+					return 0;
+				}
+				if (text[index] == ']') {
+					condition.Op = Condition::EXISTS;
+				} else {
+					if (text[index] == '=') {
+						condition.Op = Condition::EQUALS;
+					} else if (index + 1 < text.length() && text[index + 1] == '=') {
+						switch (text[index]) {
+							case '~':
+								condition.Op = Condition::INCLUDES;
+								break;
+							case '|':
+								condition.Op = Condition::DASH_MATCH;
+								break;
+							case '^':
+								condition.Op = Condition::PREFIX;
+								break;
+							case '$':
+								condition.Op = Condition::SUFFIX;
+								break;
+							case '*':
+								condition.Op = Condition::SUBSTRING;
+								break;
+							default:
+								return 0;
+						}
+						++index;
+					} else {
+						return 0;
+					}
+					++index;
+					skipSpaces(text, index);
+					if (index < text.length() && (text[index] == '"' || text[index] == '\'')) {
+						const std::size_t end = text.find(text[index], index + 1);
+						if (end == std::string::npos) {
+							return 0;
+						}
+						condition.Value = text.substr(index + 1, end - index - 1);
+						index = end + 1;
+					} else {
+						condition.Value = readName(text, index);
+					}
+					skipSpaces(text, index);
+					if (index >= text.length() || text[index] != ']') {
+						return 0;
+					}
+				}
+				++index;
+				compound.Conditions.push_back(condition);
+				selector->myUsesAttributes = true;
+			} else {
+				break;
+			}
+		}
+		if (compound.isEmpty() && !hasStar) {
+			return 0;
+		}
+
+		const std::size_t end = index;
+		skipSpaces(text, index);
+		if (index == text.length()) {
+			break;
+		}
+		if (text[index] == '>') {
+			relation = Compound::CHILD;
+			++index;
+			skipSpaces(text, index);
+		} else if (index > end) {
+			relation = Compound::DESCENDANT;
+		} else {
+			// pseudo-classes and elements, sibling combinators
+			return 0;
+		}
+	}
+
+	// the rightmost compound goes first
+	selector->myCompounds.assign(compounds.rbegin(), compounds.rend());
+	return selector;
+}
+
+CSSSelector::CSSSelector() : myUsesAttributes(false) {
+}
+
+bool CSSSelector::Condition::accepts(const std::string &value) const {
+	switch (Op) {
+		case EXISTS:
+			return true;
+		case EQUALS:
+			return value == Value;
+		case INCLUDES:
+		{
+			const std::size_t length = Value.length();
+			if (length == 0) {
+				return false;
+			}
+			for (std::size_t index = value.find(Value); index != std::string::npos; index = value.find(Value, index + 1)) {
+				if ((index == 0 || isSpace(value[index - 1])) &&
+						(index + length == value.length() || isSpace(value[index + length]))) {
+					return true;
+				}
+			}
+			return false;
+		}
+		case DASH_MATCH:
+			return value == Value || (ZLStringUtil::stringStartsWith(value, Value) && value[Value.length()] == '-');
+		case PREFIX:
+			return !Value.empty() && ZLStringUtil::stringStartsWith(value, Value);
+		case SUFFIX:
+			return !Value.empty() && ZLStringUtil::stringEndsWith(value, Value);
+		case SUBSTRING:
+			return !Value.empty() && value.find(Value) != std::string::npos;
+	}
+	return false;
+}
+
+bool CSSSelector::Compound::isEmpty() const {
+	return Tag.empty() && Id.empty() && Classes.empty() && Conditions.empty();
+}
+
+bool CSSSelector::Compound::matches(const Element &element) const {
+	if (!Tag.empty() && Tag != element.Tag) {
+		return false;
+	}
+	if (!Id.empty() && Id != element.Id) {
+		return false;
+	}
+	for (std::vector<std::string>::const_iterator it = Classes.begin(); it != Classes.end(); ++it) {
+		if (std::find(element.Classes.begin(), element.Classes.end(), *it) == element.Classes.end()) {
+			return false;
+		}
+	}
+	for (std::vector<Condition>::const_iterator it = Conditions.begin(); it != Conditions.end(); ++it) {
+		std::vector<std::pair<std::string,std::string> >::const_iterator jt = element.Attributes.begin();
+		for (; jt != element.Attributes.end() && jt->first != it->Name; ++jt) {
+		}
+		if (jt == element.Attributes.end() || !it->accepts(jt->second)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool CSSSelector::matches(const std::vector<Element> &elements) const {
+	return !elements.empty() && matches(elements, 0, elements.size() - 1);
+}
+
+bool CSSSelector::matches(const std::vector<Element> &elements, std::size_t compound, int index) const {
+	const Compound &current = myCompounds[compound];
+	if (!current.matches(elements[index])) {
+		return false;
+	}
+	switch (current.Relation) {
+		default:
+		case Compound::NONE:
+			return true;
+		case Compound::CHILD:
+			return index > 0 && matches(elements, compound + 1, index - 1);
+		case Compound::DESCENDANT:
+			for (int i = index - 1; i >= 0; --i) {
+				if (matches(elements, compound + 1, i)) {
+					return true;
+				}
+			}
+			return false;
+	}
+}
+
+int CSSSelector::specificity() const {
+	int ids = 0;
+	int classes = 0;
+	int tags = 0;
+	for (std::vector<Compound>::const_iterator it = myCompounds.begin(); it != myCompounds.end(); ++it) {
+		if (!it->Id.empty()) {
+			++ids;
+		}
+		classes += it->Classes.size() + it->Conditions.size();
+		if (!it->Tag.empty()) {
+			++tags;
+		}
+	}
+	return (std::min(ids, 255) << 16) + (std::min(classes, 255) << 8) + std::min(tags, 255);
+}
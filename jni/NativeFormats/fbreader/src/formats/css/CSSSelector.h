@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2004-2014 Geometer Plus <contact@geometerplus.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef __CSSSELECTOR_H__
+#define __CSSSELECTOR_H__
+
+#include <string>
+#include <vector>
+
+#include <shared_ptr.h>
+
+class CSSSelector {
+
+public:
+	// an element as seen by selectors; tag and attribute names are in lower case
+	struct Element {
+		std::string Tag;
+		std::string Id;
+		std::vector<std::string> Classes;
+		std::vector<std::pair<std::string,std::string> > Attributes;
+	};
+
+	// returns 0 for selectors using pseudo-classes, sibling combinators
+	// and other features we do not support
+	static shared_ptr<CSSSelector> parse(const std::string &text);
+
+private:
+	struct Condition {
+		enum Operation {
+			EXISTS,
+			EQUALS,
+			INCLUDES,
+			DASH_MATCH,
+			PREFIX,
+			SUFFIX,
+			SUBSTRING
+		};
+
+		std::string Name;
+		Operation Op;
+		std::string Value;
+
+		bool accepts(const std::string &value) const;
+	};
+
+	struct Compound {
+		enum Combinator {
+			NONE,
+			DESCENDANT,
+			CHILD
+		};
+
+		std::string Tag;
+		std::string Id;
+		std::vector<std::string> Classes;
+		std::vector<Condition> Conditions;
+		// the relation to the compound on the left
+		Combinator Relation;
+
+		bool isEmpty() const;
+		bool matches(const Element &element) const;
+	};
+
+	CSSSelector();
+
+public:
+	// elements are ordered from the root; the last one is matched
+	bool matches(const std::vector<Element> &elements) const;
+	// (ids << 16) + (classes and attributes << 8) + tags
+	int specificity() const;
+
+	// the rightmost compound is indexed by id, by class or by tag,
+	// whichever is present first; all of them are empty for '*'
+	const std::string &keyId() const;
+	const std::string &keyClass() const;
+	const std::string &keyTag() const;
+	bool usesAttributes() const;
+
+private:
+	bool matches(const std::vector<Element> &elements, std::size_t compound, int index) const;
+
+private:
+	// the rightmost compound goes first
+	std::vector<Compound> myCompounds;
+	bool myUsesAttributes;
+};
+
+inline const std::string &CSSSelector::keyId() const { return myCompounds.front().Id; }
+inline const std::string &CSSSelector::keyClass() const {
+	static const std::string EMPTY;
+	return myCompounds.front().Classes.empty() ? EMPTY : myCompounds.front().Classes.front();
+}
+inline const std::string &CSSSelector::keyTag() const { return myCompounds.front().Tag; }
+inline bool CSSSelector::usesAttributes() const { return myUsesAttributes; }
+
+#endif /* __CSSSELECTOR_H__ */
@@ -43,17 +43,18 @@ void StyleSheetTableParser::storeData(const std::string &selector, const StyleSh
 		return;
 	}
 
+	if (map.empty()) {
+		return;
+	}
+	shared_ptr<StyleSheetTable::AttributeMap> declarations;
 	const std::vector<std::string> ids = ZLStringUtil::split(s, ",");
 	for (std::vector<std::string>::const_iterator it = ids.begin(); it != ids.end(); ++it) {
-		std::string id = *it;
-		ZLStringUtil::stripWhiteSpaces(id);
-		if (!id.empty()) {
-			const std::size_t index = id.find('.');
-			if (index == std::string::npos) {
-				myTable.addMap(id, std::string(), map);
-			} else {
-				myTable.addMap(id.substr(0, index), id.substr(index + 1), map);
+		shared_ptr<CSSSelector> selector = CSSSelector::parse(*it);
+		if (!selector.isNull()) {
+			if (declarations.isNull()) {
+				declarations = new StyleSheetTable::AttributeMap(map);
 			}
+			myTable.addRule(selector, declarations);
 		}
 	}
 }
@@ -19,39 +19,105 @@
 
 #include <cstdlib>
 
+#include <algorithm>
+
 #include <ZLStringUtil.h>
 
 #include "StyleSheetTable.h"
 
+StyleSheetTable::StyleSheetTable() : myUsesAttributes(false) {
+}
+
 bool StyleSheetTable::isEmpty() const {
-	return myControlMap.empty() && myPageBreakBeforeMap.empty() && myPageBreakAfterMap.empty();
+	return myRules.empty();
+}
+
+void StyleSheetTable::addRule(shared_ptr<CSSSelector> selector, shared_ptr<AttributeMap> map) {
+	const std::size_t number = myRules.size();
+	myRules.push_back(Rule());
+	Rule &rule = myRules.back();
+	rule.Selector = selector;
+	rule.Map = map;
+	rule.Specificity = selector->specificity();
+
+	if (!selector->keyId().empty()) {
+		myIdIndex[selector->keyId()].push_back(number);
+	} else if (!selector->keyClass().empty()) {
+		myClassIndex[selector->keyClass()].push_back(number);
+	} else if (!selector->keyTag().empty()) {
+		myTagIndex[selector->keyTag()].push_back(number);
+	} else {
+		myUniversalRules.push_back(number);
+	}
+	myUsesAttributes = myUsesAttributes || selector->usesAttributes();
+	myStyleCache.clear();
 }
 
-void StyleSheetTable::addMap(const std::string &tag, const std::string &aClass, const AttributeMap &map) {
-	if ((!tag.empty() || !aClass.empty()) && !map.empty()) {
-		Key key(tag, aClass);
-		myControlMap[key] = createControl(map);
-		const std::vector<std::string> &pbb = values(map, "page-break-before");
-		if (!pbb.empty()) {
-			if ((pbb[0] == "always") ||
-					(pbb[0] == "left") ||
-					(pbb[0] == "right")) {
-				myPageBreakBeforeMap[key] = true;
-			} else if (pbb[0] == "avoid") {
-				myPageBreakBeforeMap[key] = false;
-			}
+void StyleSheetTable::collectCandidates(const std::map<std::string,std::vector<std::size_t> > &index, const std::string &key) const {
+	std::map<std::string,std::vector<std::size_t> >::const_iterator it = index.find(key);
+	if (it != index.end()) {
+		myCandidates.insert(myCandidates.end(), it->second.begin(), it->second.end());
+	}
+}
+
+static bool isPageBreak(const std::vector<std::string> &value) {
+	return !value.empty() && (value[0] == "always" || value[0] == "left" || value[0] == "right");
+}
+
+const StyleSheetTable::Style &StyleSheetTable::style(const std::vector<CSSSelector::Element> &elements) const {
+	static const Style EMPTY_STYLE;
+	if (myRules.empty() || elements.empty()) {
+		return EMPTY_STYLE;
+	}
+
+	// only rules whose rightmost compound can match are checked
+	const CSSSelector::Element &element = elements.back();
+	myCandidates.clear();
+	if (!element.Id.empty()) {
+		collectCandidates(myIdIndex, element.Id);
+	}
+	for (std::vector<std::string>::const_iterator it = element.Classes.begin(); it != element.Classes.end(); ++it) {
+		collectCandidates(myClassIndex, *it);
+	}
+	collectCandidates(myTagIndex, element.Tag);
+	myCandidates.insert(myCandidates.end(), myUniversalRules.begin(), myUniversalRules.end());
+
+	myMatched.clear();
+	for (std::vector<std::size_t>::const_iterator it = myCandidates.begin(); it != myCandidates.end(); ++it) {
+		const Rule &rule = myRules[*it];
+		if (rule.Selector->matches(elements)) {
+			myMatched.push_back(std::make_pair(rule.Specificity, *it));
 		}
-		const std::vector<std::string> &pba = values(map, "page-break-after");
-		if (!pba.empty()) {
-			if ((pba[0] == "always") ||
-					(pba[0] == "left") ||
-					(pba[0] == "right")) {
-				myPageBreakAfterMap[key] = true;
-			} else if (pba[0] == "avoid") {
-				myPageBreakAfterMap[key] = false;
-			}
+	}
+	if (myMatched.empty()) {
+		return EMPTY_STYLE;
+	}
+	// the cascade order: by specificity, then by the source order;
+	// the same rule is found twice if the element repeats a class
+	std::sort(myMatched.begin(), myMatched.end());
+	myMatched.erase(std::unique(myMatched.begin(), myMatched.end()), myMatched.end());
+
+	myKey.clear();
+	for (std::vector<std::pair<int,std::size_t> >::const_iterator it = myMatched.begin(); it != myMatched.end(); ++it) {
+		myKey.push_back(it->second);
+	}
+	std::map<std::vector<std::size_t>,Style>::iterator it = myStyleCache.lower_bound(myKey);
+	if (it != myStyleCache.end() && it->first == myKey) {
+		return it->second;
+	}
+
+	AttributeMap merged;
+	for (std::vector<std::size_t>::const_iterator jt = myKey.begin(); jt != myKey.end(); ++jt) {
+		const AttributeMap &map = *myRules[*jt].Map;
+		for (AttributeMap::const_iterator kt = map.begin(); kt != map.end(); ++kt) {
+			merged[kt->first] = kt->second;
 		}
 	}
+	Style style;
+	style.Control = createControl(merged);
+	style.PageBreakBefore = isPageBreak(values(merged, "page-break-before"));
+	style.PageBreakAfter = isPageBreak(values(merged, "page-break-after"));
+	return myStyleCache.insert(it, std::make_pair(myKey, style))->second;
 }
 
 static bool parseLength(const std::string &toParse, short &size, ZLTextStyleEntry::SizeUnit &unit) {
@@ -94,50 +160,6 @@ void StyleSheetTable::setLength(ZLTextStyleEntry &entry, ZLTextStyleEntry::Featu
 	}
 }
 
-bool StyleSheetTable::doBreakBefore(const std::string &tag, const std::string &aClass) const {
-	std::map<Key,bool>::const_iterator it = myPageBreakBeforeMap.find(Key(tag, aClass));
-	if (it != myPageBreakBeforeMap.end()) {
-		return it->second;
-	}
-
-	it = myPageBreakBeforeMap.find(Key("", aClass));
-	if (it != myPageBreakBeforeMap.end()) {
-		return it->second;
-	}
-
-	it = myPageBreakBeforeMap.find(Key(tag, ""));
-	if (it != myPageBreakBeforeMap.end()) {
-		return it->second;
-	}
-
-	return false;
-}
-
-bool StyleSheetTable::doBreakAfter(const std::string &tag, const std::string &aClass) const {
-	std::map<Key,bool>::const_iterator it = myPageBreakAfterMap.find(Key(tag, aClass));
-	if (it != myPageBreakAfterMap.end()) {
-		return it->second;
-	}
-
-	it = myPageBreakAfterMap.find(Key("", aClass));
-	if (it != myPageBreakAfterMap.end()) {
-		return it->second;
-	}
-
-	it = myPageBreakAfterMap.find(Key(tag, ""));
-	if (it != myPageBreakAfterMap.end()) {
-		return it->second;
-	}
-
-	return false;
-}
-
-shared_ptr<ZLTextStyleEntry> StyleSheetTable::control(const std::string &tag, const std::string &aClass) const {
-	std::map<Key,shared_ptr<ZLTextStyleEntry> >::const_iterator it =
-		myControlMap.find(Key(tag, aClass));
-	return (it != myControlMap.end()) ? it->second : 0;
-}
-
 const std::vector<std::string> &StyleSheetTable::values(const AttributeMap &map, const std::string &name) {
 	const AttributeMap::const_iterator it = map.find(name);
 	if (it != map.end()) {
@@ -257,7 +279,17 @@ shared_ptr<ZLTextStyleEntry> StyleSheetTable::createControl(const AttributeMap &
 }
 
 void StyleSheetTable::clear() {
-	myControlMap.clear();
-	myPageBreakBeforeMap.clear();
-	myPageBreakAfterMap.clear();
+	myRules.clear();
+	myIdIndex.clear();
+	myClassIndex.clear();
+	myTagIndex.clear();
+	myUniversalRules.clear();
+	myUsesAttributes = false;
+	myStyleCache.clear();
+}
+
+void StyleSheetTable::merge(const StyleSheetTable &table) {
+	for (std::vector<Rule>::const_iterator it = table.myRules.begin(); it != table.myRules.end(); ++it) {
+		addRule(it->Selector, it->Map);
+	}
 }
@@ -29,48 +29,75 @@
 #include <ZLTextParagraph.h>
 #include <ZLTextStyleEntry.h>
 
+#include "CSSSelector.h"
+
 class StyleSheetTable {
 
 public:
 	typedef std::map<std::string,std::vector<std::string> > AttributeMap;
 	static shared_ptr<ZLTextStyleEntry> createControl(const AttributeMap &map);
 
+	// all the rules matching an element, merged in the cascade order
+	struct Style {
+		Style();
+
+		shared_ptr<ZLTextStyleEntry> Control;
+		bool PageBreakBefore;
+		bool PageBreakAfter;
+	};
+
 private:
-	void addMap(const std::string &tag, const std::string &aClass, const AttributeMap &map);
+	void addRule(shared_ptr<CSSSelector> selector, shared_ptr<AttributeMap> map);
 
 	static void setLength(ZLTextStyleEntry &entry, ZLTextStyleEntry::Feature featureId, const AttributeMap &map, const std::string &attributeName);
 	static const std::vector<std::string> &values(const AttributeMap &map, const std::string &name);
 
 public:
+	StyleSheetTable();
+
 	bool isEmpty() const;
-	bool doBreakBefore(const std::string &tag, const std::string &aClass) const;
-	bool doBreakAfter(const std::string &tag, const std::string &aClass) const;
-	shared_ptr<ZLTextStyleEntry> control(const std::string &tag, const std::string &aClass) const;
+	// true if element attributes other than id and class are needed for matching
+	bool usesAttributes() const;
+	// elements are ordered from the root; the last one is styled
+	const Style &style(const std::vector<CSSSelector::Element> &elements) const;
 
 	void clear();
+	// rules of the given table override existing ones, as if it was parsed after them
+	void merge(const StyleSheetTable &table);
 
 private:
-	struct Key {
-		Key(const std::string &tag, const std::string &aClass);
-
-		const std::string TagName;
-		const std::string ClassName;
+	void collectCandidates(const std::map<std::string,std::vector<std::size_t> > &index, const std::string &key) const;
 
-		bool operator < (const Key &key) const;
+private:
+	struct Rule {
+		shared_ptr<CSSSelector> Selector;
+		shared_ptr<AttributeMap> Map;
+		int Specificity;
 	};
 
-	std::map<Key,shared_ptr<ZLTextStyleEntry> > myControlMap;
-	std::map<Key,bool> myPageBreakBeforeMap;
-	std::map<Key,bool> myPageBreakAfterMap;
+	// rules in the source order, indexed by the rightmost id, class or tag
+	std::vector<Rule> myRules;
+	std::map<std::string,std::vector<std::size_t> > myIdIndex;
+	std::map<std::string,std::vector<std::size_t> > myClassIndex;
+	std::map<std::string,std::vector<std::size_t> > myTagIndex;
+	std::vector<std::size_t> myUniversalRules;
+	bool myUsesAttributes;
+
+	// keyed by matched rule numbers in the cascade order
+	mutable std::map<std::vector<std::size_t>,Style> myStyleCache;
+	// buffers reused by style()
+	mutable std::vector<std::size_t> myCandidates;
+	mutable std::vector<std::pair<int,std::size_t> > myMatched;
+	mutable std::vector<std::size_t> myKey;
 
 friend class StyleSheetTableParser;
 };
 
-inline StyleSheetTable::Key::Key(const std::string &tag, const std::string &aClass) : TagName(tag), ClassName(aClass) {
+inline StyleSheetTable::Style::Style() : PageBreakBefore(false), PageBreakAfter(false) {
 }
 
-inline bool StyleSheetTable::Key::operator < (const StyleSheetTable::Key &key) const {
-	return (TagName < key.TagName) || ((TagName == key.TagName) && (ClassName < key.ClassName));
+inline bool StyleSheetTable::usesAttributes() const {
+	return myUsesAttributes;
 }
 
 #endif /* __STYLESHEETTABLE_H__ */
@@ -35,7 +35,7 @@ DocFloatImageReader::DocFloatImageReader(unsigned int off, unsigned int len, sha
 void DocFloatImageReader::readAll() {
 	//OfficeArtContent structure is described at p.405-406 [MS-DOC]
 	if (!myTableStream->seek(myOffset, true)) {
-		ZLLogger::Instance().println("DocPlugin", "problems with reading float images");
+		ZLLOG("DocPlugin", "problems with reading float images");
 		return;
 	}
 
@@ -152,7 +152,7 @@ unsigned int DocFloatImageReader::readBStoreContainerFileBlock(Blip &blip, share
 	if (blip.storeEntry.offsetInDelay != (unsigned int)-1) {
 		if (mainStream->seek(blip.storeEntry.offsetInDelay, true)) { //see p.70 [MS-ODRAW]
 			//TODO maybe we should stop reading float images here
-			ZLLogger::Instance().println("DocPlugin", "DocFloatImageReader: problems with seeking for offset");
+			ZLLOG("DocPlugin", "DocFloatImageReader: problems with seeking for offset");
 			return count;
 		}
 	}
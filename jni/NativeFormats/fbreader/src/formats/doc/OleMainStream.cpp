@@ -84,7 +84,7 @@ bool OleMainStream::open(bool doReadFormattingData) {
 	if (!result) {
 		// cant't find table stream (that can be only in case if file format is below Word 7/8), so building simple table stream
 		// TODO: CHECK may be not all old documents have ANSI
-		ZLLogger::Instance().println("DocPlugin", "cant't find table stream, building own simple piece table, that includes all charachters");
+		ZLLOG("DocPlugin", "cant't find table stream, building own simple piece table, that includes all charachters");
 		Piece piece = {myStartOfText, myEndOfText - myStartOfText, true, Piece::PIECE_TEXT, 0};
 		myPieces.push_back(piece);
 		return true;
@@ -93,7 +93,7 @@ bool OleMainStream::open(bool doReadFormattingData) {
 	result = readPieceTable(headerBuffer, tableEntry);
 
 	if (!result) {
-		ZLLogger::Instance().println("DocPlugin", "error during reading piece table");
+		ZLLOG("DocPlugin", "error during reading piece table");
 		return false;
 	}
 
@@ -160,27 +160,27 @@ bool OleMainStream::readFIB(const char *headerBuffer) {
 	int flags = OleUtil::getU2Bytes(headerBuffer, 0xA); //offset for flags
 
 	if (flags & 0x0004) { //flag for complex format
-		ZLLogger::Instance().println("DocPlugin", "This was fast-saved. Some information is lost");
+		ZLLOG("DocPlugin", "This was fast-saved. Some information is lost");
 		//lostInfo = (flags & 0xF0) >> 4);
 	}
 
 	if (flags & 0x1000) { //flag for using extending charset
-		ZLLogger::Instance().println("DocPlugin", "File uses extended character set (get_word8_char)");
+		ZLLOG("DocPlugin", "File uses extended character set (get_word8_char)");
 	} else {
-		ZLLogger::Instance().println("DocPlugin", "File uses get_8bit_char character set");
+		ZLLOG("DocPlugin", "File uses get_8bit_char character set");
 	}
 
 	if (flags & 0x100) { //flag for encrypted files
-		ZLLogger::Instance().println("DocPlugin", "File is encrypted");
+		ZLLOG("DocPlugin", "File is encrypted");
 		// Encryption key = %08lx ; NumUtil::get4Bytes(header, 14)
 		return false;
 	}
 
 	unsigned int charset = OleUtil::getU2Bytes(headerBuffer, 0x14); //offset for charset number
 	if (charset && charset != 0x100) { //0x100 = default charset
-		ZLLogger::Instance().println("DocPlugin", "Using not default character set %d");
+		ZLLOG("DocPlugin", "Using not default character set %d");
 	} else {
-		ZLLogger::Instance().println("DocPlugin", "Using default character set");
+		ZLLOG("DocPlugin", "Using default character set");
 	}
 
 	myStartOfText = OleUtil::get4Bytes(headerBuffer, 0x18); //offset for start of text value
@@ -235,11 +235,11 @@ std::string OleMainStream::getPiecesTableBuffer(const char *headerBuffer, OleStr
 	//1 step : loading CLX table from table stream
 	char *clxBuffer = new char[clxLength];
 	if (!tableStream.seek(clxOffset, true)) {
-		ZLLogger::Instance().println("DocPlugin", "getPiecesTableBuffer -- error for seeking to CLX structure");
+		ZLLOG("DocPlugin", "getPiecesTableBuffer -- error for seeking to CLX structure");
 		return std::string();
 	}
 	if (tableStream.read(clxBuffer, clxLength) != clxLength) {
-		ZLLogger::Instance().println("DocPlugin", "getPiecesTableBuffer -- CLX structure length is invalid");
+		ZLLOG("DocPlugin", "getPiecesTableBuffer -- CLX structure length is invalid");
 		return std::string();
 	}
 	std::string clx(clxBuffer, clxLength);
@@ -252,7 +252,7 @@ std::string OleMainStream::getPiecesTableBuffer(const char *headerBuffer, OleStr
 	std::string pieceTableBuffer;
 	while ((i = clx.find_first_of(0x02, from)) != std::string::npos) {
 		if (clx.size() < i + 1 + 4) {
-			ZLLogger::Instance().println("DocPlugin", "getPiecesTableBuffer -- CLX structure has invalid format");
+			ZLLOG("DocPlugin", "getPiecesTableBuffer -- CLX structure has invalid format");
 			return std::string();
 		}
 		unsigned int pieceTableLength = OleUtil::getU4Bytes(clx.c_str(), i + 1);
@@ -295,7 +295,7 @@ bool OleMainStream::readPieceTable(const char *headerBuffer, const OleEntry &tab
 	unsigned int j = 0;
 	for (j = 0; ; j += 4) {
 		if (piecesTableBuffer.size() < j + 4) {
-			ZLLogger::Instance().println("DocPlugin", "invalid piece table, cp ends not with a lastcp");
+			ZLLOG("DocPlugin", "invalid piece table, cp ends not with a lastcp");
 			break;
 		}
 		int curCP = OleUtil::get4Bytes(piecesTableBuffer.c_str(), j);
@@ -306,7 +306,7 @@ bool OleMainStream::readPieceTable(const char *headerBuffer, const OleEntry &tab
 	}
 
 	if (cp.size() < 2) {
-		ZLLogger::Instance().println("DocPlugin", "invalid piece table, < 2 pieces");
+		ZLLOG("DocPlugin", "invalid piece table, < 2 pieces");
 		return false;
 	}
 
@@ -316,7 +316,7 @@ bool OleMainStream::readPieceTable(const char *headerBuffer, const OleEntry &tab
 		//k * 8, because it should be taken 8 byte for each descriptor
 		std::size_t substrFrom = j + 4 + k * 8;
 		if (piecesTableBuffer.size() < substrFrom + 8) {
-			ZLLogger::Instance().println("DocPlugin", "invalid piece table, problems with descriptors reading");
+			ZLLOG("DocPlugin", "invalid piece table, problems with descriptors reading");
 			break;
 		}
 		descriptors.push_back(piecesTableBuffer.substr(substrFrom, 8));
@@ -325,7 +325,7 @@ bool OleMainStream::readPieceTable(const char *headerBuffer, const OleEntry &tab
 	//filling the Pieces vector
 	std::size_t minValidSize = std::min(cp.size() - 1, descriptors.size());
 	if (minValidSize == 0) {
-		ZLLogger::Instance().println("DocPlugin", "invalid piece table, there are no pieces");
+		ZLLOG("DocPlugin", "invalid piece table, there are no pieces");
 		return false;
 	}
 
@@ -400,7 +400,7 @@ bool OleMainStream::readBookmarks(const char *headerBuffer, const OleEntry &tabl
 	unsigned int offset = 0x6; //initial offset
 	for (unsigned int i = 0; i < recordsNumber; ++i) {
 		if (buffer.size() < offset + 2) {
-			ZLLogger::Instance().println("DocPlugin", "problmes with reading bookmarks names");
+			ZLLOG("DocPlugin", "problmes with reading bookmarks names");
 			break;
 		}
 		unsigned int length = OleUtil::getU2Bytes(buffer.c_str(), offset) * 2; //length of string in bytes
@@ -457,11 +457,11 @@ bool OleMainStream::readStylesheet(const char *headerBuffer, const OleEntry &tab
 	OleStream tableStream(myStorage, tableEntry, myBaseStream);
 	char *buffer = new char[stshInfoLength];
 	if (!tableStream.seek(beginStshInfo, true)) {
-		ZLLogger::Instance().println("DocPlugin", "problems with reading STSH structure");
+		ZLLOG("DocPlugin", "problems with reading STSH structure");
 		return false;
 	}
 	if (tableStream.read(buffer, stshInfoLength) != stshInfoLength) {
-		ZLLogger::Instance().println("DocPlugin", "problems with reading STSH structure, invalid length");
+		ZLLOG("DocPlugin", "problems with reading STSH structure, invalid length");
 		return false;
 	}
 
@@ -85,11 +85,11 @@ bool OleStorage::readDIFAT(char *oleBuf) {
 
 	//for files > 6.78 mb we need read additional DIFAT fields
 	for (int i = 0; difatBlock > 0 && i < difatSectorNumbers; ++i) {
-		ZLLogger::Instance().println("DocPlugin", "Read additional data for DIFAT");
+		ZLLOG("DocPlugin", "Read additional data for DIFAT");
 		char buffer[mySectorSize];
 		myInputStream->seek(BBD_BLOCK_SIZE + difatBlock * mySectorSize, true);
 		if (myInputStream->read(buffer, mySectorSize) != mySectorSize) {
-			ZLLogger::Instance().println("DocPlugin", "Error read DIFAT!");
+			ZLLOG("DocPlugin", "Error read DIFAT!");
 			return false;
 		}
 		for (unsigned int j = 0; j < (mySectorSize - 4); j += 4) {
@@ -112,19 +112,19 @@ bool OleStorage::readBBD(char *oleBuf) {
 
 	if (myDIFAT.size() < bbdNumberBlocks) {
 		//TODO maybe add check on myDIFAT == bbdNumberBlocks
-		ZLLogger::Instance().println("DocPlugin", "Wrong number of FAT blocks value");
+		ZLLOG("DocPlugin", "Wrong number of FAT blocks value");
 		return false;
 	}
 
 	for (unsigned int i = 0; i < bbdNumberBlocks; ++i) {
 		int bbdSector = myDIFAT.at(i);
 		if (bbdSector >= (int)(myStreamSize / mySectorSize) || bbdSector < 0) {
-			ZLLogger::Instance().println("DocPlugin", "Bad BBD entry!");
+			ZLLOG("DocPlugin", "Bad BBD entry!");
 			return false;
 		}
 		myInputStream->seek(BBD_BLOCK_SIZE + bbdSector * mySectorSize, true);
 		if (myInputStream->read(buffer, mySectorSize) != mySectorSize) {
-			ZLLogger::Instance().println("DocPlugin", "Error during reading BBD!");
+			ZLLOG("DocPlugin", "Error during reading BBD!");
 			return false;
 		}
 		for (unsigned int j = 0; j < mySectorSize; j += 4) {
@@ -139,7 +139,7 @@ bool OleStorage::readSBD(char *oleBuf) {
 	int sbdCount = OleUtil::get4Bytes(oleBuf, 0x40); //count of small sectors
 
 	if (sbdCur <= 0) {
-		ZLLogger::Instance().println("DocPlugin", "There's no SBD, don't read it");
+		ZLLOG("DocPlugin", "There's no SBD, don't read it");
 		return true;
 	}
 
@@ -147,7 +147,7 @@ bool OleStorage::readSBD(char *oleBuf) {
 	for (int i = 0; i < sbdCount; ++i) {
 		if (i != 0) {
 			if (sbdCur < 0 || (unsigned int)sbdCur >= myBBD.size()) {
-				ZLLogger::Instance().println("DocPlugin", "error during parsing SBD");
+				ZLLOG("DocPlugin", "error during parsing SBD");
 				return false;
 			}
 			sbdCur = myBBD.at(sbdCur);
@@ -157,7 +157,7 @@ bool OleStorage::readSBD(char *oleBuf) {
 		}
 		myInputStream->seek(BBD_BLOCK_SIZE + sbdCur * mySectorSize, true);
 		if (myInputStream->read(buffer, mySectorSize) != mySectorSize) {
-			ZLLogger::Instance().println("DocPlugin", "reading error during parsing SBD");
+			ZLLOG("DocPlugin", "reading error during parsing SBD");
 			return false;
 		}
 		for (unsigned int j = 0; j < mySectorSize; j += 4) {
@@ -171,7 +171,7 @@ bool OleStorage::readSBD(char *oleBuf) {
 bool OleStorage::readProperties(char *oleBuf) {
 	int propCur = OleUtil::get4Bytes(oleBuf, 0x30); //offset for address of sector with first property
 	if (propCur < 0) {
-		ZLLogger::Instance().println("DocPlugin", "Wrong first directory sector location");
+		ZLLOG("DocPlugin", "Wrong first directory sector location");
 		return false;
 	}
 
@@ -179,7 +179,7 @@ bool OleStorage::readProperties(char *oleBuf) {
 	do {
 		myInputStream->seek(BBD_BLOCK_SIZE + propCur * mySectorSize, true);
 		if (myInputStream->read(buffer, mySectorSize) != mySectorSize) {
-			ZLLogger::Instance().println("DocPlugin", "Error during reading properties");
+			ZLLOG("DocPlugin", "Error during reading properties");
 			return false;
 		}
 		for (unsigned int j = 0; j < mySectorSize; j += 128) {
@@ -219,7 +219,7 @@ bool OleStorage::readOleEntry(int propNumber, OleEntry &e) {
 
 	char oleType = property.at(0x42); //offset for Ole Type
 	if (oleType != 1 && oleType != 2 && oleType != 3 && oleType != 5) {
-		ZLLogger::Instance().println("DocPlugin", "entry -- not right ole type");
+		ZLLOG("DocPlugin", "entry -- not right ole type");
 		return false;
 	}
 
@@ -244,7 +244,7 @@ bool OleStorage::readOleEntry(int propNumber, OleEntry &e) {
 
 	// Read sector chain
 	if (property.size() < 0x74 + 4) {
-		ZLLogger::Instance().println("DocPlugin", "problems with reading ole entry");
+		ZLLOG("DocPlugin", "problems with reading ole entry");
 		return false;
 	}
 	int chainCur = OleUtil::get4Bytes(property.c_str(), 0x74); //offset for start block of entry
@@ -270,7 +270,7 @@ bool OleStorage::readOleEntry(int propNumber, OleEntry &e) {
 bool OleStorage::countFileOffsetOfBlock(const OleEntry &e, unsigned int blockNumber, unsigned int &result) const {
 	//TODO maybe better syntax can be used?
 	if (e.blocks.size() <= (std::size_t)blockNumber) {
-		ZLLogger::Instance().println("DocPlugin", "countFileOffsetOfBlock can't be done, blockNumber is invalid");
+		ZLLOG("DocPlugin", "countFileOffsetOfBlock can't be done, blockNumber is invalid");
 		return false;
 	}
 	if (e.isBigBlock) {
@@ -280,7 +280,7 @@ bool OleStorage::countFileOffsetOfBlock(const OleEntry &e, unsigned int blockNum
 		unsigned int sbdSectorNumber = e.blocks.at(blockNumber) / sbdPerSector;
 		unsigned int sbdSectorMod = e.blocks.at(blockNumber) % sbdPerSector;
 		if (myEntries.at(myRootEntryIndex).blocks.size() <= (std::size_t)sbdSectorNumber) {
-			ZLLogger::Instance().println("DocPlugin", "countFileOffsetOfBlock can't be done, invalid sbd data");
+			ZLLOG("DocPlugin", "countFileOffsetOfBlock can't be done, invalid sbd data");
 			return false;
 		}
 		result = BBD_BLOCK_SIZE + myEntries.at(myRootEntryIndex).blocks.at(sbdSectorNumber) * mySectorSize + sbdSectorMod * myShortSectorSize;
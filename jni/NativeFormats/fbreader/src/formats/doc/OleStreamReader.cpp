@@ -32,7 +32,7 @@ bool OleStreamReader::readDocument(shared_ptr<ZLInputStream> inputStream, bool d
 	shared_ptr<OleStorage> storage = new OleStorage;
 
 	if (!storage->init(inputStream, inputStream->sizeOfOpened())) {
-		ZLLogger::Instance().println("DocPlugin", "Broken OLE file");
+		ZLLOG("DocPlugin", "Broken OLE file");
 		return false;
 	}
 
@@ -43,7 +43,7 @@ bool OleStreamReader::readDocument(shared_ptr<ZLInputStream> inputStream, bool d
 
 	OleMainStream oleStream(storage, wordDocumentEntry, inputStream);
 	if (!oleStream.open(doReadFormattingData)) {
-		ZLLogger::Instance().println("DocPlugin", "Cannot open OleMainStream");
+		ZLLOG("DocPlugin", "Cannot open OleMainStream");
 		return false;
 	}
 	return readStream(oleStream);
@@ -69,7 +69,7 @@ bool OleStreamReader::readNextPiece(OleMainStream &stream) {
 	char *textBuffer = new char[piece.Length];
 	std::size_t readBytes = stream.read(textBuffer, piece.Length);
 	if (readBytes != (std::size_t)piece.Length) {
-		ZLLogger::Instance().println("DocPlugin", "not all bytes have been read from piece");
+		ZLLOG("DocPlugin", "not all bytes have been read from piece");
 	}
 
 	if (!piece.IsANSI) {
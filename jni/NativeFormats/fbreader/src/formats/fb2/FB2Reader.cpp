@@ -25,6 +25,8 @@
 
 #include "FB2Reader.h"
 
+#include "../util/TagNames.h"
+
 FB2Reader::FB2Reader() : myHrefPredicate(ZLXMLNamespace::XLink, "href"), myBrokenHrefPredicate("href") {
 }
 
@@ -36,56 +38,97 @@ void FB2Reader::endElementHandler(const char *t) {
 	endElementHandler(tag(t));
 }
 
-static const FB2Reader::Tag TAGS[] = {
-	{"p", FB2Reader::_P},
-	{"ul", FB2Reader::_UL},
-	{"ol", FB2Reader::_OL},
-	{"li", FB2Reader::_LI},
-	{"subtitle", FB2Reader::_SUBTITLE},
-	{"cite", FB2Reader::_CITE},
-	{"text-author", FB2Reader::_TEXT_AUTHOR},
-	{"date", FB2Reader::_DATE},
-	{"section", FB2Reader::_SECTION},
-	{"v", FB2Reader::_V},
-	{"title", FB2Reader::_TITLE},
-	{"poem", FB2Reader::_POEM},
-	{"stanza", FB2Reader::_STANZA},
-	{"epigraph", FB2Reader::_EPIGRAPH},
-	{"annotation", FB2Reader::_ANNOTATION},
-	{"sub", FB2Reader::_SUB},
-	{"sup", FB2Reader::_SUP},
-	{"code", FB2Reader::_CODE},
-	{"strikethrough", FB2Reader::_STRIKETHROUGH},
-	{"strong", FB2Reader::_STRONG},
-	{"b", FB2Reader::_STRONG},
-	{"emphasis", FB2Reader::_EMPHASIS},
-	{"i", FB2Reader::_EMPHASIS},
-	{"a", FB2Reader::_A},
-	{"image", FB2Reader::_IMAGE},
-	{"binary", FB2Reader::_BINARY},
-	{"description", FB2Reader::_DESCRIPTION},
-	{"body", FB2Reader::_BODY},
-	{"empty-line", FB2Reader::_EMPTY_LINE},
-	{"title-info", FB2Reader::_TITLE_INFO},
-	{"book-title", FB2Reader::_BOOK_TITLE},
-	{"author", FB2Reader::_AUTHOR},
-	{"lang", FB2Reader::_LANG},
-	{"first-name", FB2Reader::_FIRST_NAME},
-	{"middle-name", FB2Reader::_MIDDLE_NAME},
-	{"last-name", FB2Reader::_LAST_NAME},
-	{"coverpage", FB2Reader::_COVERPAGE},
-	{"sequence", FB2Reader::_SEQUENCE},
-	{"genre", FB2Reader::_GENRE},
-	{"document-info", FB2Reader::_DOCUMENT_INFO},
-	{"id", FB2Reader::_ID},
-	{0, FB2Reader::_UNKNOWN}
-};
-
 int FB2Reader::tag(const char *name) {
-	for (int i = 0; ; ++i) {
-		if (TAGS[i].tagName == 0 || std::strcmp(name, TAGS[i].tagName) == 0) {
-			return TAGS[i].tagCode;
-		}
+	const TagNames::Id id = TagNames::id(name);
+	// FB2 tag names are case-sensitive
+	if (id == TagNames::UNKNOWN || std::strcmp(name, TagNames::name(id)) != 0) {
+		return _UNKNOWN;
+	}
+	switch (id) {
+		case TagNames::P:
+			return _P;
+		case TagNames::UL:
+			return _UL;
+		case TagNames::OL:
+			return _OL;
+		case TagNames::LI:
+			return _LI;
+		case TagNames::SUBTITLE:
+			return _SUBTITLE;
+		case TagNames::CITE:
+			return _CITE;
+		case TagNames::TEXT_AUTHOR:
+			return _TEXT_AUTHOR;
+		case TagNames::DATE:
+			return _DATE;
+		case TagNames::SECTION:
+			return _SECTION;
+		case TagNames::V:
+			return _V;
+		case TagNames::TITLE:
+			return _TITLE;
+		case TagNames::POEM:
+			return _POEM;
+		case TagNames::STANZA:
+			return _STANZA;
+		case TagNames::EPIGRAPH:
+			return _EPIGRAPH;
+		case TagNames::ANNOTATION:
+			return _ANNOTATION;
+		case TagNames::SUB:
+			return _SUB;
+		case TagNames::SUP:
+			return _SUP;
+		case TagNames::CODE:
+			return _CODE;
+		case TagNames::STRIKETHROUGH:
+			return _STRIKETHROUGH;
+		case TagNames::STRONG:
+			return _STRONG;
+		case TagNames::B:
+			return _STRONG;
+		case TagNames::EMPHASIS:
+			return _EMPHASIS;
+		case TagNames::I:
+			return _EMPHASIS;
+		case TagNames::A:
+			return _A;
+		case TagNames::IMAGE:
+			return _IMAGE;
+		case TagNames::BINARY:
+			return _BINARY;
+		case TagNames::DESCRIPTION:
+			return _DESCRIPTION;
+		case TagNames::BODY:
+			return _BODY;
+		case TagNames::EMPTY_LINE:
+			return _EMPTY_LINE;
+		case TagNames::TITLE_INFO:
+			return _TITLE_INFO;
+		case TagNames::BOOK_TITLE:
+			return _BOOK_TITLE;
+		case TagNames::AUTHOR:
+			return _AUTHOR;
+		case TagNames::LANG:
+			return _LANG;
+		case TagNames::FIRST_NAME:
+			return _FIRST_NAME;
+		case TagNames::MIDDLE_NAME:
+			return _MIDDLE_NAME;
+		case TagNames::LAST_NAME:
+			return _LAST_NAME;
+		case TagNames::COVERPAGE:
+			return _COVERPAGE;
+		case TagNames::SEQUENCE:
+			return _SEQUENCE;
+		case TagNames::GENRE:
+			return _GENRE;
+		case TagNames::DOCUMENT_INFO:
+			return _DOCUMENT_INFO;
+		case TagNames::ID:
+			return _ID;
+		default:
+			return _UNKNOWN;
 	}
 }
 
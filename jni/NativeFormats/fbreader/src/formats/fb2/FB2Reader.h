@@ -24,12 +24,6 @@
 
 class FB2Reader : public ZLXMLReader {
 
-public:
-	struct Tag {
-		const char *tagName;
-		int tagCode;
-	};
-
 protected:
 	virtual int tag(const char *name);
 
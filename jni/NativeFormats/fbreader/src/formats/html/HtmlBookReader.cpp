@@ -435,10 +435,10 @@ bool HtmlBookReader::tagHandler(const HtmlTag &tag) {
 			break;
 		}
 	}
-	shared_ptr<HtmlTagAction> action = myActionMap[tag.Name];
+	const TagNames::Id id = TagNames::id(tag.Name);
+	shared_ptr<HtmlTagAction> &action = id != TagNames::UNKNOWN ? myActions[id] : myActionMap[tag.Name];
 	if (action.isNull()) {
 		action = createAction(tag.Name);
-		myActionMap[tag.Name] = action;
 	}
 	action->run(tag);
 
@@ -562,6 +562,11 @@ void HtmlBookReader::startDocumentHandler() {
 	myIgnoreDataCounter = 0;
 	myIsPreformatted = false;
 	myDontBreakParagraph = false;
+	for (int i = 0; i < TagNames::UNKNOWN; ++i) {
+		if (!myActions[i].isNull()) {
+			myActions[i]->reset();
+		}
+	}
 	for (std::map<std::string,shared_ptr<HtmlTagAction> >::const_iterator it = myActionMap.begin(); it != myActionMap.end(); ++it) {
 		it->second->reset();
 	}
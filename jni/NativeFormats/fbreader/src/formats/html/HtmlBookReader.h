@@ -27,6 +27,7 @@
 #include "HtmlReader.h"
 #include "../../bookmodel/BookReader.h"
 #include "../css/StyleSheetTable.h"
+#include "../util/TagNames.h"
 
 class BookModel;
 class PlainTextFormat;
@@ -79,6 +80,8 @@ private:
 	int myBreakCounter;
 	std::string myConverterBuffer;
 
+	shared_ptr<HtmlTagAction> myActions[TagNames::UNKNOWN];
+	// actions for tags that are not in TagNames
 	std::map<std::string,shared_ptr<HtmlTagAction> > myActionMap;
 	std::vector<FBTextKind> myKindList;
 
@@ -35,6 +35,7 @@
 #include "NCXReader.h"
 #include "../xhtml/XHTMLReader.h"
 #include "../util/MiscUtil.h"
+#include "../util/StreamPrefetcher.h"
 #include "../util/EntityFilesCollector.h"
 #include "../../bookmodel/BookModel.h"
 
@@ -54,6 +55,9 @@ static const std::string REFERENCE = "reference";
 static const std::string COVER = "cover";
 static const std::string COVER_IMAGE = "other.ms-coverimage-standard";
 
+// spine files inflated ahead of the one being parsed
+static const std::size_t PREFETCHED_FILES_NUMBER = 2;
+
 bool OEBBookReader::isOPFTag(const std::string &expected, const std::string &tag) const {
 	return expected == tag || testTag(ZLXMLNamespace::OpenPackagingFormat, expected, tag);
 }
@@ -223,7 +227,16 @@ bool OEBBookReader::readBook(const ZLFile &file) {
 
 	//ZLLogger::Instance().registerClass("oeb");
 	XHTMLReader xhtmlReader(myModelReader, myEncryptionMap);
+	StreamPrefetcher prefetcher;
+	std::size_t prefetchedNumber = 0;
 	for (std::vector<std::string>::const_iterator it = myHtmlFileNames.begin(); it != myHtmlFileNames.end(); ++it) {
+		const std::size_t index = it - myHtmlFileNames.begin();
+		for (; prefetchedNumber < myHtmlFileNames.size() && prefetchedNumber <= index + PREFETCHED_FILES_NUMBER; ++prefetchedNumber) {
+			const ZLFile prefetchedFile(myFilePrefix + myHtmlFileNames[prefetchedNumber]);
+			prefetcher.add(prefetchedFile.inputStream(myEncryptionMap));
+		}
+		shared_ptr<ZLInputStream> stream = prefetcher.next();
+
 		const ZLFile xhtmlFile(myFilePrefix + *it);
 		if (it == myHtmlFileNames.begin()) {
 			if (myCoverFileName == xhtmlFile.path()) {
@@ -239,7 +252,7 @@ bool OEBBookReader::readBook(const ZLFile &file) {
 			myModelReader.insertEndOfSectionParagraph();
 		}
 		//ZLLogger::Instance().println("oeb", "start " + xhtmlFile.path());
-		xhtmlReader.readFile(xhtmlFile, *it);
+		xhtmlReader.readFile(xhtmlFile, stream, *it);
 		//ZLLogger::Instance().println("oeb", "end " + xhtmlFile.path());
 		//std::string debug = "para count = ";
 		//ZLStringUtil::appendNumber(debug, myModelReader.model().bookTextModel()->paragraphsNumber());
@@ -186,7 +186,7 @@ bool OEBMetaInfoReader::processNamespaces() const {
 bool OEBMetaInfoReader::readMetaInfo(const ZLFile &file) {
 	myReadState = READ_NONE;
 	if (!readDocument(file)) {
-		ZLLogger::Instance().println("epub", "Failure while reading info from " + file.path());
+		ZLLOG_DEBUG("epub", "Failure while reading info from " + file.path());
 		return false;
 	}
 
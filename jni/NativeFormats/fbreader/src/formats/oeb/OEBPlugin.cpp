@@ -91,22 +91,22 @@ ZLFile OEBPlugin::opfFile(const ZLFile &oebFile) {
 		return oebFile;
 	}
 
-	ZLLogger::Instance().println("epub", "Looking for opf file in " + oebFile.path());
+	ZLLOG_DEBUG("epub", "Looking for opf file in " + oebFile.path());
 
 	oebFile.forceArchiveType(ZLFile::ZIP);
 	shared_ptr<ZLDir> zipDir = oebFile.directory(false);
 	if (zipDir.isNull()) {
-		ZLLogger::Instance().println("epub", "Couldn't open zip archive");
+		ZLLOG_DEBUG("epub", "Couldn't open zip archive");
 		return ZLFile::NO_FILE;
 	}
 
 	const ZLFile containerInfoFile(zipDir->itemPath("META-INF/container.xml"));
 	if (containerInfoFile.exists()) {
-		ZLLogger::Instance().println("epub", "Found container file " + containerInfoFile.path());
+		ZLLOG_DEBUG("epub", "Found container file " + containerInfoFile.path());
 		ContainerFileReader reader;
 		reader.readDocument(containerInfoFile);
 		const std::string &opfPath = reader.rootPath();
-		ZLLogger::Instance().println("epub", "opf path = " + opfPath);
+		ZLLOG_DEBUG("epub", "opf path = " + opfPath);
 		if (!opfPath.empty()) {
 			return ZLFile(zipDir->itemPath(opfPath));
 		}
@@ -115,12 +115,12 @@ ZLFile OEBPlugin::opfFile(const ZLFile &oebFile) {
 	std::vector<std::string> fileNames;
 	zipDir->collectFiles(fileNames, false);
 	for (std::vector<std::string>::const_iterator it = fileNames.begin(); it != fileNames.end(); ++it) {
-		ZLLogger::Instance().println("epub", "Item: " + *it);
+		ZLLOG_DEBUG("epub", "Item: " + *it);
 		if (ZLStringUtil::stringEndsWith(*it, ".opf")) {
 			return ZLFile(zipDir->itemPath(*it));
 		}
 	}
-	ZLLogger::Instance().println("epub", "Opf file not found");
+	ZLLOG_DEBUG("epub", "Opf file not found");
 	return ZLFile::NO_FILE;
 }
 
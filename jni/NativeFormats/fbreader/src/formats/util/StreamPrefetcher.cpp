@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2008-2014 Geometer Plus <contact@geometerplus.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <algorithm>
+
+#include <AndroidUtil.h>
+
+#include "StreamPrefetcher.h"
+
+class PrefetchedStream : public ZLInputStream {
+
+public:
+	PrefetchedStream(std::string &data);
+
+private:
+	bool open();
+	std::size_t read(char *buffer, std::size_t maxSize);
+	void close();
+
+	void seek(int offset, bool absoluteOffset);
+	std::size_t offset() const;
+	std::size_t sizeOfOpened();
+
+	const char *borrow(std::size_t &size);
+
+private:
+	std::string myData;
+	std::size_t myOffset;
+};
+
+PrefetchedStream::PrefetchedStream(std::string &data) : myOffset(0) {
+	myData.swap(data);
+}
+
+bool PrefetchedStream::open() {
+	myOffset = 0;
+	return true;
+}
+
+std::size_t PrefetchedStream::read(char *buffer, std::size_t maxSize) {
+	const std::size_t size = std::min(maxSize, myData.size() - myOffset);
+	if (buffer != 0) {
+		myData.copy(buffer, size, myOffset);
+	}
+	myOffset += size;
+	return size;
+}
+
+void PrefetchedStream::close() {
+}
+
+void PrefetchedStream::seek(int offset, bool absoluteOffset) {
+	if (!absoluteOffset) {
+		offset += myOffset;
+	}
+	myOffset = std::min((std::size_t)std::max(offset, 0), myData.size());
+}
+
+std::size_t PrefetchedStream::offset() const {
+	return myOffset;
+}
+
+std::size_t PrefetchedStream::sizeOfOpened() {
+	return myData.size();
+}
+
+const char *PrefetchedStream::borrow(std::size_t &size) {
+	size = myData.size() - myOffset;
+	return myData.data() + myOffset;
+}
+
+const std::size_t StreamPrefetcher::MaxStreamSize = 4 * 1024 * 1024;
+const std::size_t StreamPrefetcher::MaxQueuedSize = 8 * 1024 * 1024;
+
+// the buffer of a stream read ahead starts at this size and grows
+// with the bytes actually read; sizeOfOpened() of a zip entry comes
+// from the archive and can be anything
+static const std::size_t INITIAL_BUFFER_SIZE = 64 * 1024;
+
+StreamPrefetcher::StreamPrefetcher() : myReaderIsStarted(false), myQueuedSize(0), myIsStopping(false) {
+	pthread_mutex_init(&myMutex, 0);
+	pthread_cond_init(&myRequestAdded, 0);
+	pthread_cond_init(&myRequestDone, 0);
+	pthread_cond_init(&myRequestTaken, 0);
+}
+
+StreamPrefetcher::~StreamPrefetcher() {
+	if (myReaderIsStarted) {
+		pthread_mutex_lock(&myMutex);
+		myIsStopping = true;
+		pthread_cond_signal(&myRequestAdded);
+		pthread_cond_signal(&myRequestTaken);
+		pthread_mutex_unlock(&myMutex);
+		pthread_join(myReader, 0);
+	}
+	pthread_cond_destroy(&myRequestTaken);
+	pthread_cond_destroy(&myRequestDone);
+	pthread_cond_destroy(&myRequestAdded);
+	pthread_mutex_destroy(&myMutex);
+}
+
+void StreamPrefetcher::add(shared_ptr<ZLInputStream> stream) {
+	if (!stream.isNull() && !stream->open()) {
+		stream = 0;
+	}
+	const bool isSkipped = !stream.isNull() && stream->sizeOfOpened() > MaxStreamSize;
+	if (isSkipped) {
+		stream->close();
+	}
+
+	pthread_mutex_lock(&myMutex);
+	if (!myReaderIsStarted) {
+		myReaderIsStarted = pthread_create(&myReader, 0, readerThread, this) == 0;
+	}
+	myRequests.push_back(Request(stream));
+	if (stream.isNull() || isSkipped) {
+		myRequests.back().IsDone = true;
+		myRequests.back().IsSkipped = isSkipped;
+	} else {
+		pthread_cond_signal(&myRequestAdded);
+	}
+	pthread_mutex_unlock(&myMutex);
+}
+
+shared_ptr<ZLInputStream> StreamPrefetcher::next() {
+	pthread_mutex_lock(&myMutex);
+	if (myRequests.empty()) {
+		pthread_mutex_unlock(&myMutex);
+		return 0;
+	}
+	Request &request = myRequests.front();
+	if (!myReaderIsStarted && !request.IsDone) {
+		readStream(request);
+		myQueuedSize += request.Data.size();
+		request.IsDone = true;
+	}
+	while (!request.IsDone) {
+		pthread_cond_wait(&myRequestDone, &myMutex);
+	}
+	// shared pointers are not thread-safe, so they are copied
+	// and released by this thread only
+	shared_ptr<ZLInputStream> stream;
+	if (request.IsSkipped) {
+		// closed; the reader opens it again
+		stream = request.Stream;
+	} else if (!request.Stream.isNull()) {
+		myQueuedSize -= request.Data.size();
+		stream = new PrefetchedStream(request.Data);
+	}
+	myRequests.pop_front();
+	pthread_cond_signal(&myRequestTaken);
+	pthread_mutex_unlock(&myMutex);
+	return stream;
+}
+
+void StreamPrefetcher::readStream(Request &request) {
+	ZLInputStream &stream = *request.Stream;
+	std::string &data = request.Data;
+	data.resize(INITIAL_BUFFER_SIZE);
+	std::size_t length = 0;
+	while (true) {
+		if (length == data.size()) {
+			if (length > MaxStreamSize) {
+				// longer than its declared size; it is returned as is
+				std::string().swap(data);
+				request.IsSkipped = true;
+				stream.close();
+				return;
+			}
+			// a spare byte past the limit tells a stream of MaxStreamSize
+			// bytes from a longer one
+			data.resize(std::min(2 * length, MaxStreamSize + 1));
+		}
+		const std::size_t size = stream.read(&data[length], data.size() - length);
+		if (size == 0) {
+			break;
+		}
+		length += size;
+	}
+	data.resize(length);
+	stream.close();
+}
+
+bool StreamPrefetcher::hasRoomForStream() const {
+	return myQueuedSize + MaxStreamSize <= MaxQueuedSize;
+}
+
+void *StreamPrefetcher::readerThread(void *data) {
+	AndroidUtil::attachCurrentThread();
+	((StreamPrefetcher*)data)->readStreams();
+	AndroidUtil::detachCurrentThread();
+	return 0;
+}
+
+void StreamPrefetcher::readStreams() {
+	pthread_mutex_lock(&myMutex);
+	while (!myIsStopping) {
+		std::deque<Request>::iterator it = myRequests.begin();
+		for (; it != myRequests.end() && it->IsDone; ++it) {
+		}
+		if (it == myRequests.end()) {
+			pthread_cond_wait(&myRequestAdded, &myMutex);
+			continue;
+		}
+		// the streams read ahead all precede the first request not done,
+		// so next() takes them without waiting for this one
+		if (!hasRoomForStream()) {
+			pthread_cond_wait(&myRequestTaken, &myMutex);
+			continue;
+		}
+		// next() waits for the request, so it stays in place
+		Request &request = *it;
+		pthread_mutex_unlock(&myMutex);
+		readStream(request);
+		pthread_mutex_lock(&myMutex);
+		myQueuedSize += request.Data.size();
+		request.IsDone = true;
+		pthread_cond_broadcast(&myRequestDone);
+	}
+	pthread_mutex_unlock(&myMutex);
+}
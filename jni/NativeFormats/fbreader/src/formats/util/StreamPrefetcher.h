@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2008-2014 Geometer Plus <contact@geometerplus.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef __STREAMPREFETCHER_H__
+#define __STREAMPREFETCHER_H__
+
+#include <pthread.h>
+
+#include <deque>
+#include <string>
+
+#include <shared_ptr.h>
+#include <ZLInputStream.h>
+
+// Reads streams into memory on a separate thread, so decompressing the
+// next files of a book overlaps with parsing the current one.
+// Streams are opened by the calling thread (opening consults shared
+// caches) and are returned by next() in the order they were added.
+// Streams longer than MaxStreamSize are not read ahead: next() returns
+// them as they are; the worker stops reading ahead while the streams
+// waiting for next() hold more than MaxQueuedSize - MaxStreamSize bytes.
+class StreamPrefetcher {
+
+public:
+	static const std::size_t MaxStreamSize;
+	static const std::size_t MaxQueuedSize;
+
+public:
+	StreamPrefetcher();
+	~StreamPrefetcher();
+
+	// stream can be null
+	void add(shared_ptr<ZLInputStream> stream);
+	// returns an in-memory copy of the first stream not returned yet,
+	// the stream itself if it is too long to be copied,
+	// or 0 if that stream cannot be opened
+	shared_ptr<ZLInputStream> next();
+
+private:
+	struct Request {
+		Request(shared_ptr<ZLInputStream> stream);
+
+		shared_ptr<ZLInputStream> Stream;
+		std::string Data;
+		bool IsDone;
+		// the stream is too long to be read ahead
+		bool IsSkipped;
+	};
+
+	static void readStream(Request &request);
+	bool hasRoomForStream() const;
+	static void *readerThread(void *data);
+	void readStreams();
+
+private:
+	pthread_t myReader;
+	bool myReaderIsStarted;
+	pthread_mutex_t myMutex;
+	pthread_cond_t myRequestAdded;
+	pthread_cond_t myRequestDone;
+	pthread_cond_t myRequestTaken;
+	// requests are removed by next() when they are done;
+	// the elements of a deque do not move on push_back
+	std::deque<Request> myRequests;
+	// bytes read ahead and not returned by next() yet
+	std::size_t myQueuedSize;
+	bool myIsStopping;
+
+private: // disable copying
+	StreamPrefetcher(const StreamPrefetcher&);
+	const StreamPrefetcher &operator = (const StreamPrefetcher&);
+};
+
+inline StreamPrefetcher::Request::Request(shared_ptr<ZLInputStream> stream) : Stream(stream), IsDone(false), IsSkipped(false) {}
+
+#endif /* __STREAMPREFETCHER_H__ */
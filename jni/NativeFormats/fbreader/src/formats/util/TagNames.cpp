@@ -0,0 +1,187 @@
+/*
+ * This file is generated by scripts/generateTagTables.py;
+ * do not edit it manually.
+ */
+
+#include <cstring>
+#include <stdint.h>
+
+#include "TagNames.h"
+
+static const std::size_t MAX_LENGTH = 13;
+
+static const char *const NAMES[95] = {
+	"a",
+	"abbr",
+	"acronym",
+	"annotation",
+	"area",
+	"author",
+	"b",
+	"base",
+	"big",
+	"binary",
+	"blockquote",
+	"body",
+	"book-title",
+	"br",
+	"caption",
+	"center",
+	"cite",
+	"code",
+	"coverpage",
+	"date",
+	"dd",
+	"del",
+	"description",
+	"dfn",
+	"dir",
+	"div",
+	"dl",
+	"document-info",
+	"dt",
+	"em",
+	"emphasis",
+	"empty-line",
+	"epigraph",
+	"first-name",
+	"font",
+	"genre",
+	"h1",
+	"h2",
+	"h3",
+	"h4",
+	"h5",
+	"h6",
+	"head",
+	"hr",
+	"html",
+	"i",
+	"id",
+	"image",
+	"img",
+	"ins",
+	"kbd",
+	"lang",
+	"last-name",
+	"li",
+	"link",
+	"map",
+	"menu",
+	"meta",
+	"middle-name",
+	"object",
+	"ol",
+	"p",
+	"param",
+	"poem",
+	"pre",
+	"q",
+	"s",
+	"samp",
+	"script",
+	"section",
+	"select",
+	"sequence",
+	"small",
+	"span",
+	"stanza",
+	"strike",
+	"strikethrough",
+	"strong",
+	"style",
+	"sub",
+	"subtitle",
+	"sup",
+	"svg",
+	"table",
+	"td",
+	"text-author",
+	"th",
+	"title",
+	"title-info",
+	"tr",
+	"tt",
+	"u",
+	"ul",
+	"v",
+	"var",
+};
+
+static const unsigned char LENGTHS[95] = {
+	1, 4, 7, 10, 4, 6, 1, 4, 3, 6, 10, 4, 10, 2, 7, 6,
+	4, 4, 9, 4, 2, 3, 11, 3, 3, 3, 2, 13, 2, 2, 8, 10,
+	8, 10, 4, 5, 2, 2, 2, 2, 2, 2, 4, 2, 4, 1, 2, 5,
+	3, 3, 3, 4, 9, 2, 4, 3, 4, 4, 11, 6, 2, 1, 5, 4,
+	3, 1, 1, 4, 6, 7, 6, 8, 5, 4, 6, 6, 13, 6, 5, 3,
+	8, 3, 3, 5, 2, 11, 2, 5, 10, 2, 2, 1, 2, 1, 3,
+};
+
+static const unsigned char DISPLACEMENTS[64] = {
+	0, 0, 2, 2, 1, 0, 0, 5, 0, 1, 1, 0, 0, 0, 0, 0,
+	1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 2, 0,
+	0, 0, 1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0,
+	1, 0, 2, 0, 2, 0, 1, 0, 0, 0, 1, 0, 0, 0, 0, 1,
+};
+
+// id + 1, 0 for empty slots
+static const unsigned char SLOTS[256] = {
+	0, 0, 0, 90, 49, 29, 0, 0, 0, 88, 33, 0, 0, 0, 0, 0,
+	92, 0, 0, 0, 0, 80, 0, 50, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 0, 1, 0, 71, 0,
+	0, 0, 63, 0, 93, 21, 51, 0, 0, 0, 57, 0, 0, 0, 0, 44,
+	34, 28, 0, 0, 5, 85, 41, 54, 26, 77, 22, 0, 0, 0, 0, 0,
+	76, 0, 0, 0, 0, 52, 6, 64, 58, 20, 0, 0, 66, 0, 17, 0,
+	0, 0, 0, 0, 0, 15, 0, 0, 72, 23, 4, 55, 39, 59, 0, 0,
+	0, 0, 0, 0, 0, 91, 12, 0, 0, 0, 78, 0, 0, 0, 0, 0,
+	0, 0, 67, 32, 16, 0, 0, 0, 0, 0, 0, 0, 73, 0, 0, 0,
+	89, 35, 87, 37, 75, 25, 0, 0, 0, 0, 0, 0, 0, 0, 11, 0,
+	0, 83, 0, 0, 0, 0, 0, 0, 0, 13, 69, 0, 0, 0, 0, 0,
+	0, 56, 0, 24, 42, 14, 0, 0, 0, 9, 81, 60, 0, 0, 2, 95,
+	36, 82, 74, 43, 46, 68, 0, 0, 0, 94, 0, 19, 0, 70, 27, 0,
+	45, 0, 0, 0, 0, 0, 79, 53, 8, 40, 0, 0, 0, 0, 0, 84,
+	47, 0, 86, 0, 0, 7, 65, 0, 0, 0, 0, 0, 0, 0, 0, 62,
+	0, 0, 0, 0, 18, 0, 61, 31, 30, 0, 48, 0, 10, 0, 0, 38,
+};
+
+TagNames::Id TagNames::id(const char *name, std::size_t length) {
+	if (length == 0 || length > MAX_LENGTH) {
+		return UNKNOWN;
+	}
+	uint32_t hash = 2166136261U;
+	for (std::size_t i = 0; i < length; ++i) {
+		hash = (hash ^ ((unsigned char)name[i] | 0x20)) * 16777619U;
+	}
+	const int index = SLOTS[(hash + DISPLACEMENTS[hash >> 26]) & 255] - 1;
+	if (index < 0 || LENGTHS[index] != length) {
+		return UNKNOWN;
+	}
+	const char *candidate = NAMES[index];
+	for (std::size_t i = 0; i < length; ++i) {
+		char ch = name[i];
+		if (ch >= 'A' && ch <= 'Z') {
+			ch += 'a' - 'A';
+		}
+		if (ch != candidate[i]) {
+			return UNKNOWN;
+		}
+	}
+	return (Id)index;
+}
+
+TagNames::Id TagNames::id(const char *name) {
+	return id(name, std::strlen(name));
+}
+
+TagNames::Id TagNames::id(const std::string &name) {
+	return id(name.data(), name.length());
+}
+
+TagNames::Id TagNames::localId(const char *name) {
+	const char *colon = std::strchr(name, ':');
+	return id(colon != 0 ? colon + 1 : name);
+}
+
+const char *TagNames::name(Id id) {
+	return id != UNKNOWN ? NAMES[id] : "";
+}
@@ -0,0 +1,125 @@
+/*
+ * This file is generated by scripts/generateTagTables.py;
+ * do not edit it manually.
+ */
+
+#ifndef __TAGNAMES_H__
+#define __TAGNAMES_H__
+
+#include <cstddef>
+#include <string>
+
+class TagNames {
+
+public:
+	enum Id {
+		A,
+		ABBR,
+		ACRONYM,
+		ANNOTATION,
+		AREA,
+		AUTHOR,
+		B,
+		BASE,
+		BIG,
+		BINARY,
+		BLOCKQUOTE,
+		BODY,
+		BOOK_TITLE,
+		BR,
+		CAPTION,
+		CENTER,
+		CITE,
+		CODE,
+		COVERPAGE,
+		DATE,
+		DD,
+		DEL,
+		DESCRIPTION,
+		DFN,
+		DIR,
+		DIV,
+		DL,
+		DOCUMENT_INFO,
+		DT,
+		EM,
+		EMPHASIS,
+		EMPTY_LINE,
+		EPIGRAPH,
+		FIRST_NAME,
+		FONT,
+		GENRE,
+		H1,
+		H2,
+		H3,
+		H4,
+		H5,
+		H6,
+		HEAD,
+		HR,
+		HTML,
+		I,
+		ID,
+		IMAGE,
+		IMG,
+		INS,
+		KBD,
+		LANG,
+		LAST_NAME,
+		LI,
+		LINK,
+		MAP,
+		MENU,
+		META,
+		MIDDLE_NAME,
+		OBJECT,
+		OL,
+		P,
+		PARAM,
+		POEM,
+		PRE,
+		Q,
+		S,
+		SAMP,
+		SCRIPT,
+		SECTION,
+		SELECT,
+		SEQUENCE,
+		SMALL,
+		SPAN,
+		STANZA,
+		STRIKE,
+		STRIKETHROUGH,
+		STRONG,
+		STYLE,
+		SUB,
+		SUBTITLE,
+		SUP,
+		SVG,
+		TABLE,
+		TD,
+		TEXT_AUTHOR,
+		TH,
+		TITLE,
+		TITLE_INFO,
+		TR,
+		TT,
+		U,
+		UL,
+		V,
+		VAR,
+		UNKNOWN
+	};
+
+public:
+	// ASCII letters are compared ignoring case; UNKNOWN if the name is not in the table
+	static Id id(const char *name, std::size_t length);
+	static Id id(const char *name);
+	static Id id(const std::string &name);
+	// the part after the namespace prefix, if any
+	static Id localId(const char *name);
+	// lower case name
+	static const char *name(Id id);
+};
+
+#endif /* __TAGNAMES_H__ */
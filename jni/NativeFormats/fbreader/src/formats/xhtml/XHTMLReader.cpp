@@ -38,8 +38,10 @@
 #include "../../bookmodel/BookReader.h"
 #include "../../bookmodel/BookModel.h"
 
-std::map<std::string,XHTMLTagAction*> XHTMLReader::ourTagActions;
-std::map<shared_ptr<XHTMLReader::FullNamePredicate>,XHTMLTagAction*> XHTMLReader::ourNsTagActions;
+bool XHTMLReader::ourTagTableIsFilled = false;
+XHTMLTagAction *XHTMLReader::ourTagActions[TagNames::UNKNOWN];
+std::map<std::string,XHTMLTagAction*> XHTMLReader::ourOtherTagActions;
+std::map<shared_ptr<XHTMLReader::FullNamePredicate>,XHTMLTagAction*> XHTMLReader::ourNsTagActions[TagNames::UNKNOWN + 1];
 
 XHTMLTagAction::~XHTMLTagAction() {
 }
@@ -189,8 +191,8 @@ void XHTMLTagStyleAction::doAtStart(XHTMLReader &reader, const char **xmlattribu
 
 	if (reader.myReadState == XHTMLReader::READ_NOTHING) {
 		reader.myReadState = XHTMLReader::READ_STYLE;
-		reader.myTableParser = new StyleSheetTableParser(reader.myStyleSheetTable);
-		ZLLogger::Instance().println("CSS", "parsing style tag content");
+		reader.myTableParser = new StyleSheetTableParser(reader.modifiableStyleSheetTable());
+		ZLLOG_DEBUG("CSS", "parsing style tag content");
 	}
 }
 
@@ -220,15 +222,9 @@ void XHTMLTagLinkAction::doAtStart(XHTMLReader &reader, const char **xmlattribut
 	}
 
 	const std::string cssFilePath = reader.myPathPrefix + MiscUtil::decodeHtmlURL(href);
-	ZLLogger::Instance().println("CSS", "style file: " + cssFilePath);
-	shared_ptr<ZLInputStream> cssStream = ZLFile(cssFilePath).inputStream(reader.myEncryptionMap);
-	if (cssStream.isNull()) {
-		return;
-	}
-	ZLLogger::Instance().println("CSS", "parsing file");
-	StyleSheetTableParser parser(reader.myStyleSheetTable);
-	parser.parse(*cssStream);
-	//reader.myStyleSheetTable.dump();
+	ZLLOG_DEBUG("CSS", "style file: " + cssFilePath);
+	reader.addStyleSheet(ZLFile(cssFilePath));
+	//reader.myStyleSheetTable->dump();
 }
 
 void XHTMLTagLinkAction::doAtEnd(XHTMLReader&) {
@@ -417,25 +413,39 @@ void XHTMLTagPreAction::doAtEnd(XHTMLReader &reader) {
 }
 
 XHTMLTagAction *XHTMLReader::addAction(const std::string &tag, XHTMLTagAction *action) {
-	XHTMLTagAction *old = ourTagActions[tag];
-	ourTagActions[tag] = action;
+	const TagNames::Id id = TagNames::id(tag);
+	XHTMLTagAction *&slot = id != TagNames::UNKNOWN ? ourTagActions[id] : ourOtherTagActions[tag];
+	XHTMLTagAction *old = slot;
+	slot = action;
 	return old;
 }
 
 XHTMLTagAction *XHTMLReader::addAction(const std::string &ns, const std::string &name, XHTMLTagAction *action) {
 	shared_ptr<FullNamePredicate> predicate = new FullNamePredicate(ns, name);
-	XHTMLTagAction *old = ourNsTagActions[predicate];
-	ourNsTagActions[predicate] = action;
+	std::map<shared_ptr<FullNamePredicate>,XHTMLTagAction*> &nsActions = ourNsTagActions[TagNames::id(name)];
+	XHTMLTagAction *old = nsActions[predicate];
+	nsActions[predicate] = action;
 	return old;
 }
 
-XHTMLTagAction *XHTMLReader::getAction(const std::string &tag) {
-	const std::string lTag = ZLUnicodeUtil::toLower(tag);
-	XHTMLTagAction *action = ourTagActions[lTag];
-	if (action != 0) {
-		return action;
+XHTMLTagAction *XHTMLReader::getAction(const char *tag) {
+	const TagNames::Id id = TagNames::id(tag);
+	if (id != TagNames::UNKNOWN) {
+		if (ourTagActions[id] != 0) {
+			return ourTagActions[id];
+		}
+	} else if (!ourOtherTagActions.empty()) {
+		std::map<std::string,XHTMLTagAction*>::const_iterator it = ourOtherTagActions.find(ZLUnicodeUtil::toLower(tag));
+		if (it != ourOtherTagActions.end() && it->second != 0) {
+			return it->second;
+		}
 	}
-	for (std::map<shared_ptr<FullNamePredicate>,XHTMLTagAction*>::const_iterator it = ourNsTagActions.begin(); it != ourNsTagActions.end(); ++it) {
+	const std::map<shared_ptr<FullNamePredicate>,XHTMLTagAction*> &nsActions = ourNsTagActions[TagNames::localId(tag)];
+	if (nsActions.empty()) {
+		return 0;
+	}
+	const std::string lTag = ZLUnicodeUtil::toLower(tag);
+	for (std::map<shared_ptr<FullNamePredicate>,XHTMLTagAction*>::const_iterator it = nsActions.begin(); it != nsActions.end(); ++it) {
 		if (it->first->accepts(*this, lTag)) {
 			return it->second;
 		}
@@ -444,7 +454,8 @@ XHTMLTagAction *XHTMLReader::getAction(const std::string &tag) {
 }
 
 void XHTMLReader::fillTagTable() {
-	if (ourTagActions.empty()) {
+	if (!ourTagTableIsFilled) {
+		ourTagTableIsFilled = true;
 		//addAction("html", new XHTMLTagAction());
 		addAction("body", new XHTMLTagBodyAction());
 		//addAction("title", new XHTMLTagAction());
@@ -532,6 +543,10 @@ void XHTMLReader::setMarkFirstImageAsCover() {
 }
 
 bool XHTMLReader::readFile(const ZLFile &file, const std::string &referenceName) {
+	return readFile(file, file.inputStream(myEncryptionMap), referenceName);
+}
+
+bool XHTMLReader::readFile(const ZLFile &file, shared_ptr<ZLInputStream> stream, const std::string &referenceName) {
 	fillTagTable();
 
 	myPathPrefix = MiscUtil::htmlDirectoryPrefix(file.path());
@@ -547,26 +562,63 @@ bool XHTMLReader::readFile(const ZLFile &file, const std::string &referenceName)
 	myBodyCounter = 0;
 	myCurrentParagraphIsEmpty = true;
 
-	myStyleSheetTable.clear();
+	myStyleSheetKey.erase();
+	shared_ptr<StyleSheetTable> &emptyTable = myCombinedStyleSheets[myStyleSheetKey];
+	if (emptyTable.isNull()) {
+		emptyTable = new StyleSheetTable();
+	}
+	myStyleSheetTable = emptyTable;
+	myStyleSheetTableIsShared = true;
 	myCSSStack.clear();
 	myStyleEntryStack.clear();
 	myStylesToRemove = 0;
 
 	myDoPageBreakAfterStack.clear();
+	myElementStack.clear();
 	myStyleParser = new StyleSheetSingleStyleParser();
 	myTableParser.reset();
 
-	return readDocument(file.inputStream(myEncryptionMap));
+	return readDocument(stream);
 }
 
-bool XHTMLReader::addStyleEntry(const std::string tag, const std::string aClass) {
-	shared_ptr<ZLTextStyleEntry> entry = myStyleSheetTable.control(tag, aClass);
-	if (!entry.isNull()) {
-		myModelReader.addStyleEntry(*entry);
-		myStyleEntryStack.push_back(entry);
-		return true;
+void XHTMLReader::addStyleSheet(const ZLFile &file) {
+	const std::string &path = file.path();
+	std::map<std::string,shared_ptr<StyleSheetTable> >::const_iterator it = myParsedStyleSheets.find(path);
+	if (it == myParsedStyleSheets.end()) {
+		shared_ptr<StyleSheetTable> table;
+		shared_ptr<ZLInputStream> cssStream = file.inputStream(myEncryptionMap);
+		if (!cssStream.isNull()) {
+			ZLLOG_DEBUG("CSS", "parsing file");
+			table = new StyleSheetTable();
+			StyleSheetTableParser parser(*table);
+			parser.parse(*cssStream);
+		}
+		it = myParsedStyleSheets.insert(std::make_pair(path, table)).first;
+	}
+	const shared_ptr<StyleSheetTable> parsed = it->second;
+	if (parsed.isNull()) {
+		return;
 	}
-	return false;
+
+	if (!myStyleSheetTableIsShared) {
+		myStyleSheetTable->merge(*parsed);
+		return;
+	}
+	myStyleSheetKey.append(path).append(1, '\n');
+	shared_ptr<StyleSheetTable> &combined = myCombinedStyleSheets[myStyleSheetKey];
+	if (combined.isNull()) {
+		combined = new StyleSheetTable(*myStyleSheetTable);
+		combined->merge(*parsed);
+	}
+	myStyleSheetTable = combined;
+}
+
+StyleSheetTable &XHTMLReader::modifiableStyleSheetTable() {
+	if (myStyleSheetTableIsShared) {
+		myStyleSheetTable = new StyleSheetTable(*myStyleSheetTable);
+		myStyleSheetTableIsShared = false;
+	}
+	return *myStyleSheetTable;
 }
 
 void XHTMLReader::startElementHandler(const char *tag, const char **attributes) {
@@ -578,26 +630,51 @@ void XHTMLReader::startElementHandler(const char *tag, const char **attributes)
 
 	const std::string sTag = ZLUnicodeUtil::toLower(tag);
 
+	myElementStack.push_back(CSSSelector::Element());
+	CSSSelector::Element &element = myElementStack.back();
+	element.Tag = sTag;
+	if (id != 0) {
+		element.Id = id;
+	}
 	const char *aClass = attributeValue(attributes, "class");
-	const std::string sClass = (aClass != 0) ? aClass : "";
+	if (aClass != 0) {
+		for (const char *ptr = aClass; *ptr != '\0';) {
+			const char *end = ptr;
+			while (*end != '\0' && !std::isspace((unsigned char)*end)) {
+				++end;
+			}
+			if (end != ptr) {
+				element.Classes.push_back(std::string(ptr, end - ptr));
+			}
+			ptr = *end != '\0' ? end + 1 : end;
+		}
+	}
+	if (myStyleSheetTable->usesAttributes()) {
+		for (const char **a = attributes; *a != 0 && *(a + 1) != 0; a += 2) {
+			element.Attributes.push_back(std::make_pair(ZLUnicodeUtil::toLower(*a), std::string(*(a + 1))));
+		}
+	}
 
-	if (myStyleSheetTable.doBreakBefore(sTag, sClass)) {
+	// a copy: the action may change the table
+	const StyleSheetTable::Style elementStyle = myStyleSheetTable->style(myElementStack);
+	if (elementStyle.PageBreakBefore) {
 		myModelReader.insertEndOfSectionParagraph();
 	}
-	myDoPageBreakAfterStack.push_back(myStyleSheetTable.doBreakAfter(sTag, sClass));
+	myDoPageBreakAfterStack.push_back(elementStyle.PageBreakAfter);
 
-	XHTMLTagAction *action = getAction(sTag);
+	XHTMLTagAction *action = getAction(sTag.c_str());
 	if (action != 0) {
 		action->doAtStart(*this, attributes);
 	}
 
 	const int sizeBefore = myStyleEntryStack.size();
-	addStyleEntry(sTag, "");
-	addStyleEntry("", sClass);
-	addStyleEntry(sTag, sClass);
+	if (!elementStyle.Control.isNull()) {
+		myModelReader.addStyleEntry(*elementStyle.Control);
+		myStyleEntryStack.push_back(elementStyle.Control);
+	}
 	const char *style = attributeValue(attributes, "style");
 	if (style != 0) {
-		ZLLogger::Instance().println("CSS", std::string("parsing style attribute: ") + style);
+		ZLLOG_DEBUG("CSS", std::string("parsing style attribute: ") + style);
 		shared_ptr<ZLTextStyleEntry> entry = myStyleParser->parseString(style);
 		myModelReader.addStyleEntry(*entry);
 		myStyleEntryStack.push_back(entry);
@@ -626,6 +703,7 @@ void XHTMLReader::endElementHandler(const char *tag) {
 		myModelReader.insertEndOfSectionParagraph();
 	}
 	myDoPageBreakAfterStack.pop_back();
+	myElementStack.pop_back();
 }
 
 void XHTMLReader::beginParagraph() {
@@ -28,6 +28,7 @@
 
 #include "../css/StyleSheetTable.h"
 #include "../css/StyleSheetParser.h"
+#include "../util/TagNames.h"
 
 class ZLFile;
 
@@ -59,19 +60,25 @@ public:
 	static void fillTagTable();
 
 private:
-	static std::map<std::string,XHTMLTagAction*> ourTagActions;
-	static std::map<shared_ptr<FullNamePredicate>,XHTMLTagAction*> ourNsTagActions;
+	static bool ourTagTableIsFilled;
+	static XHTMLTagAction *ourTagActions[TagNames::UNKNOWN];
+	// actions for tags that are not in TagNames
+	static std::map<std::string,XHTMLTagAction*> ourOtherTagActions;
+	// indexed by local name id
+	static std::map<shared_ptr<FullNamePredicate>,XHTMLTagAction*> ourNsTagActions[TagNames::UNKNOWN + 1];
 
 public:
 	XHTMLReader(BookReader &modelReader, shared_ptr<EncryptionMap> map);
 
 	bool readFile(const ZLFile &file, const std::string &referenceName);
+	// stream is the content of file, e.g. read in advance
+	bool readFile(const ZLFile &file, shared_ptr<ZLInputStream> stream, const std::string &referenceName);
 	const std::string &fileAlias(const std::string &fileName) const;
 	const std::string normalizedReference(const std::string &reference) const;
 	void setMarkFirstImageAsCover();
 
 private:
-	XHTMLTagAction *getAction(const std::string &tag);
+	XHTMLTagAction *getAction(const char *tag);
 
 	void startElementHandler(const char *tag, const char **attributes);
 	void endElementHandler(const char *tag);
@@ -83,7 +90,8 @@ private:
 
 	void beginParagraph();
 	void endParagraph();
-	bool addStyleEntry(const std::string tag, const std::string aClass);
+	void addStyleSheet(const ZLFile &file);
+	StyleSheetTable &modifiableStyleSheetTable();
 
 private:
 	mutable std::map<std::string,std::string> myFileNumbers;
@@ -95,11 +103,18 @@ private:
 	std::string myReferenceDirName;
 	bool myPreformatted;
 	bool myNewParagraphInProgress;
-	StyleSheetTable myStyleSheetTable;
+	// linked style sheets are parsed once per book; documents linking
+	// the same files in the same order share the combined table
+	std::map<std::string,shared_ptr<StyleSheetTable> > myParsedStyleSheets;
+	std::map<std::string,shared_ptr<StyleSheetTable> > myCombinedStyleSheets;
+	shared_ptr<StyleSheetTable> myStyleSheetTable;
+	std::string myStyleSheetKey;
+	bool myStyleSheetTableIsShared;
 	std::vector<int> myCSSStack;
 	std::vector<shared_ptr<ZLTextStyleEntry> > myStyleEntryStack;
 	int myStylesToRemove;
 	std::vector<bool> myDoPageBreakAfterStack;
+	std::vector<CSSSelector::Element> myElementStack;
 	bool myCurrentParagraphIsEmpty;
 	shared_ptr<StyleSheetSingleStyleParser> myStyleParser;
 	shared_ptr<StyleSheetTableParser> myTableParser;
@@ -110,12 +110,12 @@ shared_ptr<StaticObjectMethod> AndroidUtil::StaticMethod_Tag_getTag;
 
 shared_ptr<ObjectField> AndroidUtil::Field_NativeBookModel_Book;
 shared_ptr<VoidMethod> AndroidUtil::Method_NativeBookModel_initInternalHyperlinks;
-shared_ptr<VoidMethod> AndroidUtil::Method_NativeBookModel_addTOCItem;
-shared_ptr<VoidMethod> AndroidUtil::Method_NativeBookModel_leaveTOCItem;
+shared_ptr<VoidMethod> AndroidUtil::Method_NativeBookModel_setTOC;
 shared_ptr<ObjectMethod> AndroidUtil::Method_NativeBookModel_createTextModel;
 shared_ptr<VoidMethod> AndroidUtil::Method_NativeBookModel_setBookTextModel;
-shared_ptr<VoidMethod> AndroidUtil::Method_NativeBookModel_setFootnoteModel;
-shared_ptr<VoidMethod> AndroidUtil::Method_NativeBookModel_addImage;
+shared_ptr<VoidMethod> AndroidUtil::Method_NativeBookModel_setBookTextModelPrefix;
+shared_ptr<VoidMethod> AndroidUtil::Method_NativeBookModel_setFootnotes;
+shared_ptr<VoidMethod> AndroidUtil::Method_NativeBookModel_addImages;
 
 //shared_ptr<StaticObjectMethod> AndroidUtil::StaticMethod_BookReadingException_throwForFile;
 
@@ -125,6 +125,15 @@ JNIEnv *AndroidUtil::getEnv() {
 	return env;
 }
 
+void AndroidUtil::attachCurrentThread() {
+	JNIEnv *env;
+	ourJavaVM->AttachCurrentThread(&env, 0);
+}
+
+void AndroidUtil::detachCurrentThread() {
+	ourJavaVM->DetachCurrentThread();
+}
+
 bool AndroidUtil::init(JavaVM* jvm) {
 	ourJavaVM = jvm;
 
@@ -186,12 +195,12 @@ bool AndroidUtil::init(JavaVM* jvm) {
 
 	Field_NativeBookModel_Book = new ObjectField(Class_NativeBookModel, "Book", Class_Book);
 	Method_NativeBookModel_initInternalHyperlinks = new VoidMethod(Class_NativeBookModel, "initInternalHyperlinks", "(Ljava/lang/String;Ljava/lang/String;I)");
-	Method_NativeBookModel_addTOCItem = new VoidMethod(Class_NativeBookModel, "addTOCItem", "(Ljava/lang/String;I)");
-	Method_NativeBookModel_leaveTOCItem = new VoidMethod(Class_NativeBookModel, "leaveTOCItem", "()");
-	Method_NativeBookModel_createTextModel = new ObjectMethod(Class_NativeBookModel, "createTextModel", Class_ZLTextModel, "(Ljava/lang/String;Ljava/lang/String;I[I[I[I[I[BLjava/lang/String;Ljava/lang/String;I)");
+	Method_NativeBookModel_setTOC = new VoidMethod(Class_NativeBookModel, "setTOC", "([I[I[I[C)");
+	Method_NativeBookModel_createTextModel = new ObjectMethod(Class_NativeBookModel, "createTextModel", Class_ZLTextModel, "(Ljava/lang/String;Ljava/lang/String;I[I[I[I[I[B[CLjava/lang/String;Ljava/lang/String;I)");
 	Method_NativeBookModel_setBookTextModel = new VoidMethod(Class_NativeBookModel, "setBookTextModel", "(Lorg/geometerplus/zlibrary/text/model/ZLTextModel;)");
-	Method_NativeBookModel_setFootnoteModel = new VoidMethod(Class_NativeBookModel, "setFootnoteModel", "(Lorg/geometerplus/zlibrary/text/model/ZLTextModel;)");
-	Method_NativeBookModel_addImage = new VoidMethod(Class_NativeBookModel, "addImage", "(Ljava/lang/String;Lorg/geometerplus/zlibrary/core/image/ZLImage;)");
+	Method_NativeBookModel_setBookTextModelPrefix = new VoidMethod(Class_NativeBookModel, "setBookTextModelPrefix", "(Lorg/geometerplus/zlibrary/text/model/ZLTextModel;)");
+	Method_NativeBookModel_setFootnotes = new VoidMethod(Class_NativeBookModel, "setFootnotes", "(Lorg/geometerplus/zlibrary/text/model/ZLTextModel;[Ljava/lang/String;[I)");
+	Method_NativeBookModel_addImages = new VoidMethod(Class_NativeBookModel, "addImages", "([Ljava/lang/String;[Ljava/lang/String;[I[I[I)");
 
 /*
 	Class_BookReadingException = new JavaClass(env, "org/geometerplus/fbreader/bookmodel/BookReadingException");
@@ -132,18 +132,21 @@ public:
 
 	static shared_ptr<ObjectField> Field_NativeBookModel_Book;
 	static shared_ptr<VoidMethod> Method_NativeBookModel_initInternalHyperlinks;
-	static shared_ptr<VoidMethod> Method_NativeBookModel_addTOCItem;
-	static shared_ptr<VoidMethod> Method_NativeBookModel_leaveTOCItem;
+	static shared_ptr<VoidMethod> Method_NativeBookModel_setTOC;
 	static shared_ptr<ObjectMethod> Method_NativeBookModel_createTextModel;
 	static shared_ptr<VoidMethod> Method_NativeBookModel_setBookTextModel;
-	static shared_ptr<VoidMethod> Method_NativeBookModel_setFootnoteModel;
-	static shared_ptr<VoidMethod> Method_NativeBookModel_addImage;
+	static shared_ptr<VoidMethod> Method_NativeBookModel_setBookTextModelPrefix;
+	static shared_ptr<VoidMethod> Method_NativeBookModel_setFootnotes;
+	static shared_ptr<VoidMethod> Method_NativeBookModel_addImages;
 
 	//static shared_ptr<StaticObjectMethod> StaticMethod_BookReadingException_throwForFile;
 
 public:
 	static bool init(JavaVM* jvm);
 	static JNIEnv *getEnv();
+	// for native threads that may call Java code, e.g. via JavaInputStream
+	static void attachCurrentThread();
+	static void detachCurrentThread();
 
 	static std::string fromJavaString(JNIEnv *env, jstring from);
 	static jstring createJavaString(JNIEnv* env, const std::string &str);
@@ -112,9 +112,9 @@ ObjectField::ObjectField(const JavaClass &cls, const std::string &name, const Ja
 }
 
 jobject ObjectField::value(jobject obj) const {
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "getting value of ObjectField " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "getting value of ObjectField " + myName);
 	jobject val = AndroidUtil::getEnv()->GetObjectField(obj, myId);
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "got value of ObjectField " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "got value of ObjectField " + myName);
 	return val;
 }
 
@@ -122,24 +122,24 @@ VoidMethod::VoidMethod(const JavaClass &cls, const std::string &name, const std:
 }
 
 void VoidMethod::call(jobject base, ...) {
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "calling VoidMethod " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "calling VoidMethod " + myName);
 	va_list lst;
 	va_start(lst, base);
 	AndroidUtil::getEnv()->CallVoidMethodV(base, myId, lst);
 	va_end(lst);
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "finished VoidMethod " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "finished VoidMethod " + myName);
 }
 
 IntMethod::IntMethod(const JavaClass &cls, const std::string &name, const std::string &parameters) : Method(cls, name, JavaPrimitiveType::Int, parameters) {
 }
 
 jint IntMethod::call(jobject base, ...) {
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "calling IntMethod " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "calling IntMethod " + myName);
 	va_list lst;
 	va_start(lst, base);
 	jint result = AndroidUtil::getEnv()->CallIntMethodV(base, myId, lst);
 	va_end(lst);
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "finished IntMethod " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "finished IntMethod " + myName);
 	return result;
 }
 
@@ -147,12 +147,12 @@ LongMethod::LongMethod(const JavaClass &cls, const std::string &name, const std:
 }
 
 jlong LongMethod::call(jobject base, ...) {
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "calling LongMethod " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "calling LongMethod " + myName);
 	va_list lst;
 	va_start(lst, base);
 	jlong result = AndroidUtil::getEnv()->CallLongMethodV(base, myId, lst);
 	va_end(lst);
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "finished LongMethod " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "finished LongMethod " + myName);
 	return result;
 }
 
@@ -160,12 +160,12 @@ BooleanMethod::BooleanMethod(const JavaClass &cls, const std::string &name, cons
 }
 
 jboolean BooleanMethod::call(jobject base, ...) {
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "calling BooleanMethod " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "calling BooleanMethod " + myName);
 	va_list lst;
 	va_start(lst, base);
 	jboolean result = AndroidUtil::getEnv()->CallBooleanMethodV(base, myId, lst);
 	va_end(lst);
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "finished BooleanMethod " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "finished BooleanMethod " + myName);
 	return result;
 }
 
@@ -175,17 +175,17 @@ StringMethod::StringMethod(const JavaClass &cls, const std::string &name, const
 }
 
 jstring StringMethod::callForJavaString(jobject base, ...) {
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "calling StringMethod " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "calling StringMethod " + myName);
 	va_list lst;
 	va_start(lst, base);
 	jstring result = (jstring)AndroidUtil::getEnv()->CallObjectMethodV(base, myId, lst);
 	va_end(lst);
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "finished StringMethod " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "finished StringMethod " + myName);
 	return result;
 }
 
 std::string StringMethod::callForCppString(jobject base, ...) {
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "calling StringMethod " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "calling StringMethod " + myName);
 	JNIEnv *env = AndroidUtil::getEnv();
 	va_list lst;
 	va_start(lst, base);
@@ -195,7 +195,7 @@ std::string StringMethod::callForCppString(jobject base, ...) {
 	if (j != 0) {
 		env->DeleteLocalRef(j);
 	}
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "calling StringMethod " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "calling StringMethod " + myName);
 	return str;
 }
 
@@ -203,12 +203,12 @@ ObjectMethod::ObjectMethod(const JavaClass &cls, const std::string &name, const
 }
 
 jobject ObjectMethod::call(jobject base, ...) {
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "calling ObjectMethod " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "calling ObjectMethod " + myName);
 	va_list lst;
 	va_start(lst, base);
 	jobject result = AndroidUtil::getEnv()->CallObjectMethodV(base, myId, lst);
 	va_end(lst);
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "finished ObjectMethod " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "finished ObjectMethod " + myName);
 	return result;
 }
 
@@ -216,12 +216,12 @@ ObjectArrayMethod::ObjectArrayMethod(const JavaClass &cls, const std::string &na
 }
 
 jobjectArray ObjectArrayMethod::call(jobject base, ...) {
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "calling ObjectArrayMethod " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "calling ObjectArrayMethod " + myName);
 	va_list lst;
 	va_start(lst, base);
 	jobjectArray result = (jobjectArray)AndroidUtil::getEnv()->CallObjectMethodV(base, myId, lst);
 	va_end(lst);
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "finished ObjectArrayMethod " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "finished ObjectArrayMethod " + myName);
 	return result;
 }
 
@@ -229,11 +229,11 @@ StaticObjectMethod::StaticObjectMethod(const JavaClass &cls, const std::string &
 }
 
 jobject StaticObjectMethod::call(...) {
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "calling StaticObjectMethod " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "calling StaticObjectMethod " + myName);
 	va_list lst;
 	va_start(lst, this);
 	jobject result = AndroidUtil::getEnv()->CallStaticObjectMethodV(jClass(), myId, lst);
 	va_end(lst);
-	ZLLogger::Instance().println(JNI_LOGGER_CLASS, "finished StaticObjectMethod " + myName);
+	ZLLOG_DEBUG(JNI_LOGGER_CLASS, "finished StaticObjectMethod " + myName);
 	return result;
 }
@@ -51,6 +51,7 @@ public:
 protected:
 	virtual void normalizeRealPath(std::string &path) const = 0;
 	virtual ZLInputStream *createPlainInputStream(const std::string &path) const = 0;
+	virtual ZLInputStream *createMappedInputStream(const std::string &path) const;
 	virtual ZLOutputStream *createOutputStream(const std::string &path) const = 0;
 	virtual ZLFSDir *createPlainDirectory(const std::string &path) const = 0;
 	virtual ZLFSDir *createNewDirectory(const std::string &path) const = 0;
@@ -77,5 +78,6 @@ friend class ZLDir;
 inline ZLFSManager &ZLFSManager::Instance() { return *ourInstance; }
 inline ZLFSManager::ZLFSManager() {}
 inline ZLFSManager::~ZLFSManager() {}
+inline ZLInputStream *ZLFSManager::createMappedInputStream(const std::string &path) const { return createPlainInputStream(path); }
 
 #endif /* __ZLFSMANAGER_H__ */
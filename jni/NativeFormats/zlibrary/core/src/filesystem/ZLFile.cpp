@@ -129,6 +129,14 @@ shared_ptr<ZLInputStream> ZLFile::inputStream(shared_ptr<EncryptionMap> encrypti
 	return stream;
 }
 
+shared_ptr<ZLInputStream> ZLFile::mappedInputStream() const {
+	if (isCompressed() || isDirectory() ||
+			ZLFSManager::Instance().findArchiveFileNameDelimiter(myPath) != -1) {
+		return inputStream();
+	}
+	return ZLFSManager::Instance().createMappedInputStream(myPath);
+}
+
 shared_ptr<ZLOutputStream> ZLFile::outputStream(bool writeThrough) const {
 	if (!writeThrough && isCompressed()) {
 		return 0;
@@ -238,6 +246,13 @@ std::size_t ZLFile::size() const {
 	return myInfo.Size;
 }
 
+long ZLFile::lastModified() const {
+	if (!myInfoIsFilled) {
+		fillInfo();
+	}
+	return myInfo.LastModified;
+}
+
 bool ZLFile::isDirectory() const {
 	if (!myInfoIsFilled) {
 		fillInfo();
@@ -59,6 +59,7 @@ public:
 
 	bool exists() const;
 	std::size_t size() const;	
+	long lastModified() const;
 
 	void forceArchiveType(ArchiveType type) const;
 
@@ -81,6 +82,10 @@ public:
 	std::string resolvedPath() const;
 
 	shared_ptr<ZLInputStream> inputStream(shared_ptr<EncryptionMap> encryptionMap = 0) const;
+	// reads a plain file through a memory mapping; only for files this
+	// application replaces as a whole (by renaming a new file over them):
+	// reading a mapped file truncated by somebody else raises SIGBUS
+	shared_ptr<ZLInputStream> mappedInputStream() const;
 	shared_ptr<ZLOutputStream> outputStream(bool writeThrough = false) const;
 	shared_ptr<ZLDir> directory(bool createUnexisting = false) const;
 
@@ -24,11 +24,12 @@ struct ZLFileInfo {
 	bool Exists;
 	bool IsDirectory;
 	std::size_t Size;
+	long LastModified;
 
 	ZLFileInfo();
 };
 
-inline ZLFileInfo::ZLFileInfo() : Exists(false), IsDirectory(false), Size(0) {
+inline ZLFileInfo::ZLFileInfo() : Exists(false), IsDirectory(false), Size(0), LastModified(0) {
 }
 
 #endif /* __ZLFILEINFO_H__ */
@@ -35,10 +35,17 @@ public:
 	virtual std::size_t read(char *buffer, std::size_t maxSize) = 0;
 	virtual void close() = 0;
 
+	// offsets are int, so nothing past the first 2 GB can be seeked to
 	virtual void seek(int offset, bool absoluteOffset) = 0;
 	virtual std::size_t offset() const = 0;
 	virtual std::size_t sizeOfOpened() = 0;
 
+	// returns a pointer to the data at the current offset and sets size
+	// to the number of bytes available there, or returns 0 if the stream
+	// cannot expose its data without copying; the data stays valid
+	// until the stream is closed, the offset is not changed
+	virtual const char *borrow(std::size_t &size);
+
 private:
 	// disable copying
 	ZLInputStream(const ZLInputStream&);
@@ -59,6 +66,8 @@ private:
 	std::size_t offset() const;
 	std::size_t sizeOfOpened();
 
+	const char *borrow(std::size_t &size);
+
 private:
 	shared_ptr<ZLInputStream> myBaseStream;
 	std::size_t myBaseOffset;
@@ -66,5 +75,6 @@ private:
 
 inline ZLInputStream::ZLInputStream() {}
 inline ZLInputStream::~ZLInputStream() {}
+inline const char *ZLInputStream::borrow(std::size_t &size) { size = 0; return 0; }
 
 #endif /* __ZLINPUTSTREAM_H__ */
@@ -55,3 +55,8 @@ std::size_t ZLInputStreamDecorator::offset() const {
 std::size_t ZLInputStreamDecorator::sizeOfOpened() {
 	return myBaseStream->sizeOfOpened();
 }
+
+const char *ZLInputStreamDecorator::borrow(std::size_t &size) {
+	myBaseStream->seek(myBaseOffset, true);
+	return myBaseStream->borrow(size);
+}
@@ -79,15 +79,59 @@ bool ZLGzipInputStream::open() {
 		myBaseStream->seek(2, false);
 	}
 
-	myDecompressor = new ZLZDecompressor(myFileSize - myBaseStream->offset() - 8);
+	myDataOffset = myBaseStream->offset();
+	myCompressedSize = myFileSize - myDataOffset - 8;
+	createDecompressor(0);
 	myOffset = 0;
 
 	return true;
 }
 
+void ZLGzipInputStream::createDecompressor(std::size_t compressedOffset) {
+	myDecompressor = new ZLZDecompressor(myCompressedSize - compressedOffset);
+	collectCheckpoints();
+}
+
+void ZLGzipInputStream::collectCheckpoints() {
+	const std::size_t spacing = ZLInflateCheckpoint::spacing(myCheckpoints, ZLZDecompressor::CheckpointSpacing);
+	myDecompressor->collectCheckpoints(
+		(myCheckpoints.empty() ? 0 : myCheckpoints.back().OutputOffset) + spacing, spacing
+	);
+}
+
+bool ZLGzipInputStream::restoreCheckpoint(std::size_t offset) {
+	const ZLInflateCheckpoint *checkpoint = ZLInflateCheckpoint::find(myCheckpoints, offset);
+	if (checkpoint == 0) {
+		return false;
+	}
+	if (offset >= myOffset && checkpoint->OutputOffset <= myOffset) {
+		// going on from the current position is not slower
+		return false;
+	}
+	myBaseStream->seek(myDataOffset + checkpoint->InputOffset, true);
+	createDecompressor(checkpoint->InputOffset);
+	if (!myDecompressor->restore(*checkpoint)) {
+		open();
+		return false;
+	}
+	myOffset = checkpoint->OutputOffset;
+	return true;
+}
+
 std::size_t ZLGzipInputStream::read(char *buffer, std::size_t maxSize) {
 	std::size_t realSize = myDecompressor->decompress(*myBaseStream, buffer, maxSize);
 	myOffset += realSize;
+	std::vector<ZLInflateCheckpoint> checkpoints;
+	myDecompressor->takeCheckpoints(checkpoints);
+	if (!checkpoints.empty()) {
+		for (std::vector<ZLInflateCheckpoint>::const_iterator it = checkpoints.begin(); it != checkpoints.end(); ++it) {
+			ZLInflateCheckpoint::add(myCheckpoints, *it);
+		}
+		if (myCheckpoints.size() > ZLInflateCheckpoint::MaxNumber) {
+			ZLInflateCheckpoint::thin(myCheckpoints);
+			collectCheckpoints();
+		}
+	}
 	return realSize;
 }
 
@@ -97,9 +141,14 @@ void ZLGzipInputStream::close() {
 }
 
 void ZLGzipInputStream::seek(int offset, bool absoluteOffset) {
-	if (absoluteOffset) {
-		offset -= this->offset();
+	if (!absoluteOffset) {
+		offset += this->offset();
+	}
+	if (offset >= 0 && restoreCheckpoint(offset)) {
+		read(0, offset - myOffset);
+		return;
 	}
+	offset -= this->offset();
 	if (offset > 0) {
 		read(0, offset);
 	} else if (offset < 0) {
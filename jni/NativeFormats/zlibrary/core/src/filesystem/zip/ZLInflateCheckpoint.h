@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2004-2014 Geometer Plus <contact@geometerplus.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef __ZLINFLATECHECKPOINT_H__
+#define __ZLINFLATECHECKPOINT_H__
+
+#include <string>
+#include <vector>
+
+// a point inside a deflate stream where decompression can be restarted
+struct ZLInflateCheckpoint {
+	// offsets from the start of uncompressed/compressed data
+	std::size_t OutputOffset;
+	std::size_t InputOffset;
+	// number of unused bits in the byte preceding InputOffset, and the byte itself
+	int Bits;
+	unsigned char Byte;
+	// last (up to) 32K of output preceding OutputOffset
+	std::string Window;
+
+	// at most this number of checkpoints is kept for a stream
+	static const std::size_t MaxNumber;
+
+	static const ZLInflateCheckpoint *find(const std::vector<ZLInflateCheckpoint> &checkpoints, std::size_t offset);
+	static void add(std::vector<ZLInflateCheckpoint> &checkpoints, const ZLInflateCheckpoint &checkpoint);
+	// drops every second checkpoint, so the spacing is doubled
+	static void thin(std::vector<ZLInflateCheckpoint> &checkpoints);
+	// the spacing of the last checkpoints, minSpacing multiplied by a power of two
+	static std::size_t spacing(const std::vector<ZLInflateCheckpoint> &checkpoints, std::size_t minSpacing);
+	static std::size_t memorySize(const std::vector<ZLInflateCheckpoint> &checkpoints);
+};
+
+#endif /* __ZLINFLATECHECKPOINT_H__ */
@@ -24,15 +24,81 @@
 #include "../ZLInputStream.h"
 #include "ZLZDecompressor.h"
 
-const std::size_t IN_BUFFER_SIZE = 2048;
 const std::size_t OUT_BUFFER_SIZE = 32768;
+const std::size_t WINDOW_SIZE = 32768;
+// smaller requests are served from the output buffer,
+// to avoid calling inflate for every few bytes
+const std::size_t DIRECT_OUTPUT_THRESHOLD = 1024;
+// keeps avail_in within uInt when compressed data is borrowed from the stream
+const std::size_t MAX_BORROWED_INPUT = 1 << 30;
 
-ZLZDecompressor::ZLZDecompressor(std::size_t size) : myAvailableSize(size) {
+std::size_t ZLZDecompressor::InputBufferSize = 16384;
+std::size_t ZLZDecompressor::CheckpointSpacing = 1024 * 1024;
+
+// with 32K windows, up to 512K per stream
+const std::size_t ZLInflateCheckpoint::MaxNumber = 16;
+
+const ZLInflateCheckpoint *ZLInflateCheckpoint::find(const std::vector<ZLInflateCheckpoint> &checkpoints, std::size_t offset) {
+	const ZLInflateCheckpoint *found = 0;
+	for (std::vector<ZLInflateCheckpoint>::const_iterator it = checkpoints.begin(); it != checkpoints.end(); ++it) {
+		if (it->OutputOffset > offset) {
+			break;
+		}
+		found = &*it;
+	}
+	return found;
+}
+
+void ZLInflateCheckpoint::add(std::vector<ZLInflateCheckpoint> &checkpoints, const ZLInflateCheckpoint &checkpoint) {
+	std::vector<ZLInflateCheckpoint>::iterator it = checkpoints.begin();
+	for (; it != checkpoints.end(); ++it) {
+		if (it->OutputOffset == checkpoint.OutputOffset) {
+			return;
+		}
+		if (it->OutputOffset > checkpoint.OutputOffset) {
+			break;
+		}
+	}
+	checkpoints.insert(it, checkpoint);
+}
+
+void ZLInflateCheckpoint::thin(std::vector<ZLInflateCheckpoint> &checkpoints) {
+	std::size_t count = 0;
+	for (std::size_t i = 0; i < checkpoints.size(); i += 2) {
+		if (i != count) {
+			checkpoints[count] = checkpoints[i];
+		}
+		++count;
+	}
+	checkpoints.erase(checkpoints.begin() + count, checkpoints.end());
+}
+
+std::size_t ZLInflateCheckpoint::spacing(const std::vector<ZLInflateCheckpoint> &checkpoints, std::size_t minSpacing) {
+	std::size_t spacing = minSpacing;
+	const std::size_t size = checkpoints.size();
+	if (size >= 2 && spacing > 0) {
+		// checkpoints are made at block boundaries, so the distance is a bit larger
+		const std::size_t distance = checkpoints[size - 1].OutputOffset - checkpoints[size - 2].OutputOffset;
+		while (spacing * 2 <= distance) {
+			spacing *= 2;
+		}
+	}
+	return spacing;
+}
+
+std::size_t ZLInflateCheckpoint::memorySize(const std::vector<ZLInflateCheckpoint> &checkpoints) {
+	std::size_t size = 0;
+	for (std::vector<ZLInflateCheckpoint>::const_iterator it = checkpoints.begin(); it != checkpoints.end(); ++it) {
+		size += sizeof(ZLInflateCheckpoint) + it->Window.length();
+	}
+	return size;
+}
+
+ZLZDecompressor::ZLZDecompressor(std::size_t size) : myAvailableSize(size), myInBufferSize(InputBufferSize), myInBuffer(0), myInputStart(0), myOutStart(0), myOutLength(0), myInputBase(0), myOutputBase(0), myCollectCheckpoints(false), myNextCheckpoint(0), myCheckpointSpacing(0), myWindowPosition(0) {
 	myZStream = new z_stream;
 	memset(myZStream, 0, sizeof(z_stream));
 	inflateInit2(myZStream, -MAX_WBITS);
 
-	myInBuffer = new char[IN_BUFFER_SIZE];
 	myOutBuffer = new char[OUT_BUFFER_SIZE];
 }
 
@@ -44,42 +110,178 @@ ZLZDecompressor::~ZLZDecompressor() {
 	delete myZStream;
 }
 
-std::size_t ZLZDecompressor::decompress(ZLInputStream &stream, char *buffer, std::size_t maxSize) {
-	while (myBuffer.length() < maxSize && myAvailableSize > 0) {
-		std::size_t size = std::min(myAvailableSize, (std::size_t)IN_BUFFER_SIZE);
+bool ZLZDecompressor::restore(const ZLInflateCheckpoint &checkpoint) {
+	if (checkpoint.Bits > 0 &&
+			inflatePrime(myZStream, checkpoint.Bits, checkpoint.Byte >> (8 - checkpoint.Bits)) != Z_OK) {
+		return false;
+	}
+	if (!checkpoint.Window.empty() &&
+			inflateSetDictionary(myZStream, (const Bytef*)checkpoint.Window.data(), checkpoint.Window.length()) != Z_OK) {
+		return false;
+	}
+	myInputBase = checkpoint.InputOffset;
+	myOutputBase = checkpoint.OutputOffset;
+	if (myCollectCheckpoints) {
+		myWindow.clear();
+		updateWindow(checkpoint.Window.data(), checkpoint.Window.length());
+	}
+	return true;
+}
 
-		myZStream->next_in = (Bytef*)myInBuffer;
-		myZStream->avail_in = stream.read(myInBuffer, size);
-		if (myZStream->avail_in == size) {
-			myAvailableSize -= size;
-		} else {
-			myAvailableSize = 0;
+void ZLZDecompressor::collectCheckpoints(std::size_t offset, std::size_t spacing) {
+	if (spacing == 0) {
+		return;
+	}
+	myCollectCheckpoints = true;
+	myNextCheckpoint = offset;
+	myCheckpointSpacing = spacing;
+}
+
+void ZLZDecompressor::takeCheckpoints(std::vector<ZLInflateCheckpoint> &checkpoints) {
+	checkpoints.insert(checkpoints.end(), myCheckpoints.begin(), myCheckpoints.end());
+	myCheckpoints.clear();
+}
+
+void ZLZDecompressor::updateWindow(const char *data, std::size_t length) {
+	if (length >= WINDOW_SIZE) {
+		myWindow.assign(data + length - WINDOW_SIZE, WINDOW_SIZE);
+		myWindowPosition = 0;
+	} else if (myWindow.length() < WINDOW_SIZE) {
+		const std::size_t toAppend = std::min(length, WINDOW_SIZE - myWindow.length());
+		myWindow.append(data, toAppend);
+		myWindowPosition = myWindow.length() % WINDOW_SIZE;
+		if (toAppend < length) {
+			updateWindow(data + toAppend, length - toAppend);
 		}
+	} else {
+		const std::size_t tail = std::min(length, WINDOW_SIZE - myWindowPosition);
+		std::memcpy((char*)myWindow.data() + myWindowPosition, data, tail);
+		std::memcpy((char*)myWindow.data(), data + tail, length - tail);
+		myWindowPosition = (myWindowPosition + length) % WINDOW_SIZE;
+	}
+}
+
+void ZLZDecompressor::addCheckpoint() {
+	const int bits = myZStream->data_type & 7;
+	if (bits > 0 && (const char*)myZStream->next_in == myInputStart) {
+		// the byte with unused bits is not in the buffer any more
+		return;
+	}
+	myCheckpoints.push_back(ZLInflateCheckpoint());
+	ZLInflateCheckpoint &checkpoint = myCheckpoints.back();
+	checkpoint.OutputOffset = myOutputBase + myZStream->total_out;
+	checkpoint.InputOffset = myInputBase + myZStream->total_in;
+	checkpoint.Bits = bits;
+	checkpoint.Byte = bits > 0 ? myZStream->next_in[-1] : 0;
+	if (myWindow.length() < WINDOW_SIZE) {
+		checkpoint.Window = myWindow;
+	} else {
+		checkpoint.Window.reserve(WINDOW_SIZE);
+		checkpoint.Window.append(myWindow, myWindowPosition, WINDOW_SIZE - myWindowPosition);
+		checkpoint.Window.append(myWindow, 0, myWindowPosition);
+	}
+	if (myCheckpoints.size() > ZLInflateCheckpoint::MaxNumber) {
+		// a long skip, the checkpoints are not taken in the meantime
+		ZLInflateCheckpoint::thin(myCheckpoints);
+		myCheckpointSpacing *= 2;
+	}
+	myNextCheckpoint = myCheckpoints.back().OutputOffset + myCheckpointSpacing;
+}
+
+std::size_t ZLZDecompressor::inflate(ZLInputStream &stream, char *buffer, std::size_t size) {
+	myZStream->next_out = (Bytef*)buffer;
+	myZStream->avail_out = size;
+	while (myZStream->avail_out > 0) {
 		if (myZStream->avail_in == 0) {
+			if (myAvailableSize == 0) {
+				break;
+			}
+			std::size_t borrowedSize;
+			const char *borrowed = stream.borrow(borrowedSize);
+			if (borrowed != 0 && borrowedSize > 0) {
+				// inflate straight from the stream memory; the stream
+				// is moved forward as if the data were read
+				const std::size_t size = std::min(std::min(myAvailableSize, borrowedSize), MAX_BORROWED_INPUT);
+				stream.seek(size, false);
+				myZStream->next_in = (Bytef*)borrowed;
+				myZStream->avail_in = size;
+				myAvailableSize -= size;
+			} else {
+				if (myInBuffer == 0) {
+					myInBuffer = new char[myInBufferSize];
+				}
+				const std::size_t toRead = std::min(myAvailableSize, myInBufferSize);
+				myZStream->next_in = (Bytef*)myInBuffer;
+				myZStream->avail_in = stream.read(myInBuffer, toRead);
+				if (myZStream->avail_in == toRead) {
+					myAvailableSize -= toRead;
+				} else {
+					myAvailableSize = 0;
+				}
+				if (myZStream->avail_in == 0) {
+					break;
+				}
+			}
+			myInputStart = (const char*)myZStream->next_in;
+		}
+
+		Bytef *start = myZStream->next_out;
+		// Z_BLOCK stops at deflate block boundaries, where checkpoints can be made
+		const int code = ::inflate(myZStream, myCollectCheckpoints ? Z_BLOCK : Z_SYNC_FLUSH);
+		if (myCollectCheckpoints && myZStream->next_out != start) {
+			updateWindow((const char*)start, myZStream->next_out - start);
+		}
+		if (code == Z_STREAM_END) {
+			stream.seek(0 - myZStream->avail_in, false);
+			myZStream->avail_in = 0;
+			myAvailableSize = 0;
+			break;
+		} else if (code != Z_OK) {
+			myZStream->avail_in = 0;
+			myAvailableSize = 0;
 			break;
 		}
-		while (myZStream->avail_in > 0) {
-			myZStream->avail_out = OUT_BUFFER_SIZE;
-			myZStream->next_out = (Bytef*)myOutBuffer;
-			int code = ::inflate(myZStream, Z_SYNC_FLUSH);
-			if (code != Z_OK && code != Z_STREAM_END) {
+		if (myCollectCheckpoints &&
+				(myZStream->data_type & 128) != 0 && (myZStream->data_type & 64) == 0 &&
+				myOutputBase + myZStream->total_out >= myNextCheckpoint) {
+			addCheckpoint();
+		}
+	}
+	return size - myZStream->avail_out;
+}
+
+std::size_t ZLZDecompressor::decompress(ZLInputStream &stream, char *buffer, std::size_t maxSize) {
+	std::size_t realSize = std::min(maxSize, myOutLength);
+	if (realSize > 0) {
+		if (buffer != 0) {
+			std::memcpy(buffer, myOutBuffer + myOutStart, realSize);
+		}
+		myOutStart += realSize;
+		myOutLength -= realSize;
+	}
+
+	while (realSize < maxSize) {
+		const std::size_t rest = maxSize - realSize;
+		if (buffer != 0 && rest >= DIRECT_OUTPUT_THRESHOLD) {
+			const std::size_t size = inflate(stream, buffer + realSize, rest);
+			realSize += size;
+			if (size < rest) {
 				break;
 			}
-			if (OUT_BUFFER_SIZE != myZStream->avail_out) {
-				myBuffer.append(myOutBuffer, OUT_BUFFER_SIZE - myZStream->avail_out);
-			}
-			if (code == Z_STREAM_END) {
-				myAvailableSize = 0;
-				stream.seek(0 - myZStream->avail_in, false);
+		} else {
+			// when skipping, nothing is inflated beyond the requested size
+			const std::size_t size = inflate(stream, myOutBuffer, buffer != 0 ? OUT_BUFFER_SIZE : std::min(rest, OUT_BUFFER_SIZE));
+			if (size == 0) {
 				break;
 			}
+			const std::size_t used = std::min(size, rest);
+			if (buffer != 0) {
+				std::memcpy(buffer + realSize, myOutBuffer, used);
+			}
+			realSize += used;
+			myOutStart = used;
+			myOutLength = size - used;
 		}
 	}
-
-	std::size_t realSize = std::min(maxSize, myBuffer.length());
-	if (buffer != 0) {
-		std::memcpy(buffer, myBuffer.data(), realSize);
-	}
-	myBuffer.erase(0, realSize);
 	return realSize;
 }
@@ -23,23 +23,62 @@
 #include <zlib.h>
 
 #include <string>
+#include <vector>
+
+#include "ZLInflateCheckpoint.h"
 
 class ZLInputStream;
 
 class ZLZDecompressor {
 
+public:
+	// size of compressed data chunks read from the stream
+	static std::size_t InputBufferSize;
+	// distance between checkpoints in uncompressed data; 0 disables checkpoints
+	static std::size_t CheckpointSpacing;
+
 public:
 	ZLZDecompressor(std::size_t size);
 	~ZLZDecompressor();
 
+	// continues decompression from the checkpoint; the input stream must be
+	// positioned at checkpoint.InputOffset, and size counts bytes after it
+	bool restore(const ZLInflateCheckpoint &checkpoint);
+	// starts collecting checkpoints at block boundaries, the first one
+	// at or after offset, next ones spacing bytes apart; the spacing is
+	// doubled when more than ZLInflateCheckpoint::MaxNumber are collected
+	void collectCheckpoints(std::size_t offset, std::size_t spacing);
+	void takeCheckpoints(std::vector<ZLInflateCheckpoint> &checkpoints);
+
 	std::size_t decompress(ZLInputStream &stream, char *buffer, std::size_t maxSize);
 
+private:
+	std::size_t inflate(ZLInputStream &stream, char *buffer, std::size_t size);
+	void updateWindow(const char *data, std::size_t length);
+	void addCheckpoint();
+
 private:
 	z_stream *myZStream;
 	std::size_t myAvailableSize;
+	const std::size_t myInBufferSize;
+	// allocated on demand, unused while the input stream lends its data
 	char *myInBuffer;
+	// start of the current input chunk
+	const char *myInputStart;
+	// inflated but not yet returned data is myOutBuffer[myOutStart, myOutStart + myOutLength)
 	char *myOutBuffer;
-	std::string myBuffer;
+	std::size_t myOutStart;
+	std::size_t myOutLength;
+
+	std::size_t myInputBase;
+	std::size_t myOutputBase;
+	bool myCollectCheckpoints;
+	std::size_t myNextCheckpoint;
+	std::size_t myCheckpointSpacing;
+	// circular buffer with the last 32K of output
+	std::string myWindow;
+	std::size_t myWindowPosition;
+	std::vector<ZLInflateCheckpoint> myCheckpoints;
 };
 
 #endif /* __ZLZDECOMPRESSOR_H__ */
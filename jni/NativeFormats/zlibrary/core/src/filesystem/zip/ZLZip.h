@@ -26,36 +26,68 @@
 
 #include "../ZLInputStream.h"
 #include "../ZLDir.h"
+#include "ZLInflateCheckpoint.h"
 
 class ZLZDecompressor;
 class ZLFile;
 
-class ZLZipEntryCache {
-
-public:
-	static shared_ptr<ZLZipEntryCache> cache(const std::string &containerName, ZLInputStream &containerStream);
+class ZLZipCacheLock;
 
-private:
-	static const std::size_t ourStorageSize;
-	static shared_ptr<ZLZipEntryCache> *ourStoredCaches;
-	static std::size_t ourIndex;
+class ZLZipEntryCache {
 
 public:
 	struct Info {
 		Info();
 
+		bool exists() const;
+
+		// offset of entry data; -1 if not known yet (see HeaderOffset)
 		int Offset;
+		// offset of the local file header; data starts after its name and extra fields
+		int HeaderOffset;
 		int CompressionMethod;
 		int CompressedSize;
 		int UncompressedSize;
 	};
 
+	struct Statistics {
+		Statistics();
+
+		std::size_t Hits;
+		std::size_t Misses;
+		std::size_t Evictions;
+		std::size_t Invalidations;
+		std::size_t MemoryUsed;
+	};
+
+	// the methods below are thread-safe; caches are kept per container,
+	// in LRU order, and are dropped when container size or mtime changes
+	static Info info(const std::string &containerName, ZLInputStream &containerStream, const std::string &entryName);
+	static void collectFileNames(const std::string &containerName, ZLInputStream &containerStream, std::vector<std::string> &names);
+
+	// inflate checkpoints of deflated entries are kept with the cache, see ZLZDecompressor;
+	// they count against the memory budget, and are thinned to fit in it
+	static bool findCheckpoint(const std::string &containerName, const std::string &entryName, std::size_t offset, ZLInflateCheckpoint &checkpoint);
+	// returns the offset of the next checkpoint to collect for the entry
+	static std::size_t nextCheckpointOffset(const std::string &containerName, const std::string &entryName, std::size_t &spacing);
+	static void addCheckpoints(const std::string &containerName, const std::string &entryName, const std::vector<ZLInflateCheckpoint> &checkpoints);
+
+	static void setMemoryBudget(std::size_t budget);
+	static Statistics statistics();
+
+private:
+	static const ZLZipEntryCache &cache(const std::string &containerName, ZLInputStream &containerStream, ZLZipCacheLock &lock);
+	static void evict(std::size_t budget);
+	static void thinCheckpoints(std::size_t budget);
+
 private:
 	ZLZipEntryCache(const std::string &containerName, ZLInputStream &containerStream);
+	bool readCentralDirectory(ZLInputStream &containerStream);
+	void readLocalHeaders(ZLInputStream &containerStream);
 
-public:
 	Info info(const std::string &entryName) const;
 	void collectFileNames(std::vector<std::string> &names) const;
+	std::size_t memorySize() const;
 
 private:
 	const std::string myContainerName;
@@ -77,6 +109,13 @@ public:
 	std::size_t offset() const;
 	std::size_t sizeOfOpened();
 
+	const char *borrow(std::size_t &size);
+
+private:
+	void createDecompressor(std::size_t compressedOffset);
+	void collectCheckpoints();
+	bool restoreCheckpoint(std::size_t offset);
+
 private:
 	shared_ptr<ZLInputStream> myBaseStream;
 	std::string myBaseName;
@@ -84,7 +123,9 @@ private:
 	bool myIsDeflated;
 
 	std::size_t myUncompressedSize;
+	std::size_t myCompressedSize;
 	std::size_t myAvailableSize;
+	std::size_t myDataOffset;
 	std::size_t myOffset;
 
 	shared_ptr<ZLZDecompressor> myDecompressor;
@@ -107,13 +148,21 @@ public:
 	std::size_t offset() const;
 	std::size_t sizeOfOpened();
 
+private:
+	void createDecompressor(std::size_t compressedOffset);
+	void collectCheckpoints();
+	bool restoreCheckpoint(std::size_t offset);
+
 private:
 	shared_ptr<ZLInputStream> myBaseStream;
 	std::size_t myFileSize;
+	std::size_t myDataOffset;
+	std::size_t myCompressedSize;
 
 	std::size_t myOffset;
 
 	shared_ptr<ZLZDecompressor> myDecompressor;
+	std::vector<ZLInflateCheckpoint> myCheckpoints;
 
 friend class ZLFile;
 };
@@ -134,6 +183,8 @@ protected:
 friend class ZLFile;
 };
 
+inline bool ZLZipEntryCache::Info::exists() const { return Offset != -1 || HeaderOffset != -1; }
+
 inline ZLZipDir::ZLZipDir(const std::string &name) : ZLDir(name) {}
 inline ZLZipDir::~ZLZipDir() {}
 //inline void ZLZipDir::collectSubDirs(std::vector<std::string>&, bool) {}
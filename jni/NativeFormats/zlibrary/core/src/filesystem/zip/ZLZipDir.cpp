@@ -23,8 +23,7 @@
 
 void ZLZipDir::collectFiles(std::vector<std::string> &names, bool) {
 	shared_ptr<ZLInputStream> stream = ZLFile(path()).inputStream();
-	shared_ptr<ZLZipEntryCache> cache = ZLZipEntryCache::cache(path(), *stream);
-	cache->collectFileNames(names);
+	ZLZipEntryCache::collectFileNames(path(), *stream, names);
 }
 
 std::string ZLZipDir::delimiter() const {
@@ -17,33 +17,236 @@
  * 02110-1301, USA.
  */
 
+#include <pthread.h>
+#include <stdint.h>
+#include <climits>
+#include <algorithm>
+#include <list>
+
 #include <AndroidUtil.h>
 #include <ZLLogger.h>
 
 #include "ZLZip.h"
 #include "ZLZipHeader.h"
+#include "ZLZDecompressor.h"
+#include "../ZLFile.h"
+
+struct ZLZipCacheRecord {
+	shared_ptr<ZLZipEntryCache> Cache;
+	std::size_t MemorySize;
+	std::size_t FileSize;
+	long LastModified;
+	std::list<std::string>::iterator LruPosition;
+	std::map<std::string,std::vector<ZLInflateCheckpoint> > Checkpoints;
+};
+
+static pthread_mutex_t ourMutex = PTHREAD_MUTEX_INITIALIZER;
+static std::map<std::string,ZLZipCacheRecord> ourRecords;
+// container names, most recently used first
+static std::list<std::string> ourLruList;
+static std::size_t ourMemoryBudget = 512 * 1024;
+static ZLZipEntryCache::Statistics ourStatistics;
+
+class ZLZipCacheLock {
 
-const std::size_t ZLZipEntryCache::ourStorageSize = 5;
-shared_ptr<ZLZipEntryCache> *ZLZipEntryCache::ourStoredCaches =
-	 new shared_ptr<ZLZipEntryCache>[ourStorageSize];
-std::size_t ZLZipEntryCache::ourIndex = 0;
+public:
+	ZLZipCacheLock(bool locked = true);
+	~ZLZipCacheLock();
+	void lock();
+	void unlock();
+
+private:
+	bool myIsLocked;
+};
+
+ZLZipCacheLock::ZLZipCacheLock(bool locked) : myIsLocked(false) {
+	if (locked) {
+		lock();
+	}
+}
 
-shared_ptr<ZLZipEntryCache> ZLZipEntryCache::cache(const std::string &containerName, ZLInputStream &containerStream) {
+ZLZipCacheLock::~ZLZipCacheLock() {
+	unlock();
+}
+
+void ZLZipCacheLock::lock() {
+	if (!myIsLocked) {
+		pthread_mutex_lock(&ourMutex);
+		myIsLocked = true;
+	}
+}
+
+void ZLZipCacheLock::unlock() {
+	if (myIsLocked) {
+		myIsLocked = false;
+		pthread_mutex_unlock(&ourMutex);
+	}
+}
+
+ZLZipEntryCache::Statistics::Statistics() : Hits(0), Misses(0), Evictions(0), Invalidations(0), MemoryUsed(0) {
+}
+
+static void removeRecord(std::map<std::string,ZLZipCacheRecord>::iterator it) {
+	ourStatistics.MemoryUsed -= it->second.MemorySize;
+	ourLruList.erase(it->second.LruPosition);
+	ourRecords.erase(it);
+}
+
+// is called without the lock and returns with the lock held;
+// the result is valid until the lock is released
+const ZLZipEntryCache &ZLZipEntryCache::cache(const std::string &containerName, ZLInputStream &containerStream, ZLZipCacheLock &lock) {
 	//ZLLogger::Instance().registerClass("ZipEntryCache");
 	//ZLLogger::Instance().println("ZipEntryCache", "requesting cache for " + containerName);
-	for (std::size_t i = 0; i < ourStorageSize; ++i) {
-		shared_ptr<ZLZipEntryCache> cache = ourStoredCaches[i];
-		if (!cache.isNull() && cache->myContainerName == containerName) {
-			return cache;
+	// the file info may come from a JNI call, other threads should not wait for it
+	const ZLFile physicalFile(ZLFile(containerName).physicalFilePath());
+	const std::size_t fileSize = physicalFile.size();
+	const long lastModified = physicalFile.lastModified();
+	lock.lock();
+
+	std::map<std::string,ZLZipCacheRecord>::iterator it = ourRecords.find(containerName);
+	if (it != ourRecords.end()) {
+		if (it->second.FileSize == fileSize && it->second.LastModified == lastModified) {
+			++ourStatistics.Hits;
+			ourLruList.splice(ourLruList.begin(), ourLruList, it->second.LruPosition);
+			return *it->second.Cache;
 		}
+		++ourStatistics.Invalidations;
+		removeRecord(it);
 	}
+	++ourStatistics.Misses;
+
+	// reading the archive may take a while, other threads should not wait for it
+	lock.unlock();
 	shared_ptr<ZLZipEntryCache> cache = new ZLZipEntryCache(containerName, containerStream);
-	ourStoredCaches[ourIndex] = cache;
-	ourIndex = (ourIndex + 1) % ourStorageSize;
-	return cache;
+	lock.lock();
+
+	it = ourRecords.find(containerName);
+	if (it != ourRecords.end()) {
+		// another thread has read the same container meanwhile
+		removeRecord(it);
+	}
+	ZLZipCacheRecord &record = ourRecords[containerName];
+	record.Cache = cache;
+	record.MemorySize = cache->memorySize();
+	record.FileSize = fileSize;
+	record.LastModified = lastModified;
+	record.LruPosition = ourLruList.insert(ourLruList.begin(), containerName);
+	ourStatistics.MemoryUsed += record.MemorySize;
+	evict(ourMemoryBudget);
+	return *cache;
+}
+
+// is called with the lock held; the most recently used cache is never evicted
+void ZLZipEntryCache::evict(std::size_t budget) {
+	while (ourStatistics.MemoryUsed > budget && ourLruList.size() > 1) {
+		removeRecord(ourRecords.find(ourLruList.back()));
+		++ourStatistics.Evictions;
+	}
+}
+
+ZLZipEntryCache::Info ZLZipEntryCache::info(const std::string &containerName, ZLInputStream &containerStream, const std::string &entryName) {
+	ZLZipCacheLock lock(false);
+	return cache(containerName, containerStream, lock).info(entryName);
+}
+
+void ZLZipEntryCache::collectFileNames(const std::string &containerName, ZLInputStream &containerStream, std::vector<std::string> &names) {
+	ZLZipCacheLock lock(false);
+	cache(containerName, containerStream, lock).collectFileNames(names);
+}
+
+bool ZLZipEntryCache::findCheckpoint(const std::string &containerName, const std::string &entryName, std::size_t offset, ZLInflateCheckpoint &checkpoint) {
+	ZLZipCacheLock lock;
+	std::map<std::string,ZLZipCacheRecord>::const_iterator it = ourRecords.find(containerName);
+	if (it == ourRecords.end()) {
+		return false;
+	}
+	std::map<std::string,std::vector<ZLInflateCheckpoint> >::const_iterator jt = it->second.Checkpoints.find(entryName);
+	if (jt == it->second.Checkpoints.end()) {
+		return false;
+	}
+	const ZLInflateCheckpoint *found = ZLInflateCheckpoint::find(jt->second, offset);
+	if (found == 0) {
+		return false;
+	}
+	checkpoint = *found;
+	return true;
+}
+
+std::size_t ZLZipEntryCache::nextCheckpointOffset(const std::string &containerName, const std::string &entryName, std::size_t &spacing) {
+	ZLZipCacheLock lock;
+	spacing = ZLZDecompressor::CheckpointSpacing;
+	std::map<std::string,ZLZipCacheRecord>::const_iterator it = ourRecords.find(containerName);
+	if (it == ourRecords.end()) {
+		return spacing;
+	}
+	std::map<std::string,std::vector<ZLInflateCheckpoint> >::const_iterator jt = it->second.Checkpoints.find(entryName);
+	if (jt == it->second.Checkpoints.end() || jt->second.empty()) {
+		return spacing;
+	}
+	spacing = ZLInflateCheckpoint::spacing(jt->second, spacing);
+	return jt->second.back().OutputOffset + spacing;
+}
+
+void ZLZipEntryCache::addCheckpoints(const std::string &containerName, const std::string &entryName, const std::vector<ZLInflateCheckpoint> &checkpoints) {
+	ZLZipCacheLock lock;
+	std::map<std::string,ZLZipCacheRecord>::iterator it = ourRecords.find(containerName);
+	if (it == ourRecords.end()) {
+		return;
+	}
+	std::vector<ZLInflateCheckpoint> &stored = it->second.Checkpoints[entryName];
+	const std::size_t oldSize = ZLInflateCheckpoint::memorySize(stored);
+	for (std::vector<ZLInflateCheckpoint>::const_iterator jt = checkpoints.begin(); jt != checkpoints.end(); ++jt) {
+		ZLInflateCheckpoint::add(stored, *jt);
+	}
+	if (stored.size() > ZLInflateCheckpoint::MaxNumber) {
+		ZLInflateCheckpoint::thin(stored);
+	}
+	const std::size_t newSize = ZLInflateCheckpoint::memorySize(stored);
+	it->second.MemorySize += newSize - oldSize;
+	ourStatistics.MemoryUsed += newSize - oldSize;
+	evict(ourMemoryBudget);
+	thinCheckpoints(ourMemoryBudget);
+}
+
+// is called with the lock held, after evict(); the most recently used
+// cache is never evicted, so its checkpoints are thinned to fit in the budget
+void ZLZipEntryCache::thinCheckpoints(std::size_t budget) {
+	if (ourStatistics.MemoryUsed <= budget || ourLruList.empty()) {
+		return;
+	}
+	ZLZipCacheRecord &record = ourRecords.find(ourLruList.front())->second;
+	while (ourStatistics.MemoryUsed > budget) {
+		// the entry with most checkpoints is thinned first
+		std::vector<ZLInflateCheckpoint> *largest = 0;
+		for (std::map<std::string,std::vector<ZLInflateCheckpoint> >::iterator it = record.Checkpoints.begin(); it != record.Checkpoints.end(); ++it) {
+			if (largest == 0 || it->second.size() > largest->size()) {
+				largest = &it->second;
+			}
+		}
+		if (largest == 0 || largest->size() <= 1) {
+			break;
+		}
+		const std::size_t oldSize = ZLInflateCheckpoint::memorySize(*largest);
+		ZLInflateCheckpoint::thin(*largest);
+		const std::size_t freed = oldSize - ZLInflateCheckpoint::memorySize(*largest);
+		record.MemorySize -= freed;
+		ourStatistics.MemoryUsed -= freed;
+	}
+}
+
+void ZLZipEntryCache::setMemoryBudget(std::size_t budget) {
+	ZLZipCacheLock lock;
+	ourMemoryBudget = budget;
+	evict(budget);
+	thinCheckpoints(budget);
+}
+
+ZLZipEntryCache::Statistics ZLZipEntryCache::statistics() {
+	ZLZipCacheLock lock;
+	return ourStatistics;
 }
 
-ZLZipEntryCache::Info::Info() : Offset(-1) {
+ZLZipEntryCache::Info::Info() : Offset(-1), HeaderOffset(-1) {
 }
 
 ZLZipEntryCache::ZLZipEntryCache(const std::string &containerName, ZLInputStream &containerStream) : myContainerName(containerName) {
@@ -52,6 +255,198 @@ ZLZipEntryCache::ZLZipEntryCache(const std::string &containerName, ZLInputStream
 		return;
 	}
 
+	if (!readCentralDirectory(containerStream)) {
+		ZLLOG("zip", "Cannot read central directory of " + containerName + "; scanning local headers");
+		myInfoMap.clear();
+		containerStream.close();
+		if (!containerStream.open()) {
+			return;
+		}
+		readLocalHeaders(containerStream);
+	}
+	containerStream.close();
+}
+
+static const std::size_t EndOfCentralDirectorySize = 22;
+static const std::size_t Zip64EndOfCentralDirectorySize = 56;
+static const std::size_t Zip64EndOfCentralDirectoryLocatorSize = 20;
+static const std::size_t CentralDirectoryHeaderSize = 46;
+static const std::size_t MaxCommentLength = 0xFFFF;
+static const unsigned short Zip64ExtraFieldId = 0x0001;
+
+static unsigned short readShort(const char *ptr) {
+	return
+		((((unsigned short)ptr[1]) & 0xFF) << 8) +
+		((unsigned short)ptr[0] & 0xFF);
+}
+
+static unsigned long readLong(const char *ptr) {
+	return
+		((((unsigned long)ptr[3]) & 0xFF) << 24) +
+		((((unsigned long)ptr[2]) & 0xFF) << 16) +
+		((((unsigned long)ptr[1]) & 0xFF) << 8) +
+		((unsigned long)ptr[0] & 0xFF);
+}
+
+static uint64_t readLongLong(const char *ptr) {
+	return (((uint64_t)readLong(ptr + 4)) << 32) + readLong(ptr);
+}
+
+static bool readAt(ZLInputStream &stream, std::size_t offset, char *buffer, std::size_t size) {
+	stream.seek(offset, true);
+	return stream.offset() == offset && stream.read(buffer, size) == size;
+}
+
+// replaces 0xFFFFFFFF values by the ones from ZIP64 extended information field
+static void readZip64Extra(const char *extra, std::size_t extraLength, uint64_t &uncompressedSize, uint64_t &compressedSize, uint64_t &headerOffset) {
+	const char *end = extra + extraLength;
+	while (extra + 4 <= end) {
+		const unsigned short id = readShort(extra);
+		const char *data = extra + 4;
+		extra = data + readShort(extra + 2);
+		if (id != Zip64ExtraFieldId || extra > end) {
+			continue;
+		}
+		if (uncompressedSize == 0xFFFFFFFF && data + 8 <= extra) {
+			uncompressedSize = readLongLong(data);
+			data += 8;
+		}
+		if (compressedSize == 0xFFFFFFFF && data + 8 <= extra) {
+			compressedSize = readLongLong(data);
+			data += 8;
+		}
+		if (headerOffset == 0xFFFFFFFF && data + 8 <= extra) {
+			headerOffset = readLongLong(data);
+		}
+		return;
+	}
+}
+
+bool ZLZipEntryCache::readCentralDirectory(ZLInputStream &containerStream) {
+	const std::size_t fileSize = containerStream.sizeOfOpened();
+	// stream offsets are ints, so larger archives cannot be addressed anyway
+	if (fileSize < EndOfCentralDirectorySize || fileSize > (std::size_t)INT_MAX) {
+		return false;
+	}
+
+	const std::size_t tailSize = std::min(
+		fileSize,
+		EndOfCentralDirectorySize + MaxCommentLength + Zip64EndOfCentralDirectoryLocatorSize
+	);
+	const std::size_t tailOffset = fileSize - tailSize;
+	std::string tail(tailSize, '\0');
+	if (!readAt(containerStream, tailOffset, (char*)tail.data(), tailSize)) {
+		return false;
+	}
+
+	// the record is followed by a comment only, so we look for it from the end
+	int eocd = tailSize - EndOfCentralDirectorySize;
+	for (; eocd >= 0; --eocd) {
+		const char *ptr = tail.data() + eocd;
+		if (readLong(ptr) == (unsigned long)ZLZipHeader::SignatureEndOfCentralDirectory &&
+				eocd + EndOfCentralDirectorySize + readShort(ptr + 20) <= tailSize) {
+			break;
+		}
+	}
+	if (eocd < 0) {
+		return false;
+	}
+
+	const char *record = tail.data() + eocd;
+	uint64_t entryCount = readShort(record + 10);
+	uint64_t directorySize = readLong(record + 12);
+	uint64_t directoryOffset = readLong(record + 16);
+	std::size_t directoryEnd = tailOffset + eocd;
+
+	if (entryCount == 0xFFFF || directorySize == 0xFFFFFFFF || directoryOffset == 0xFFFFFFFF) {
+		if ((std::size_t)eocd < Zip64EndOfCentralDirectoryLocatorSize) {
+			return false;
+		}
+		const char *locator = record - Zip64EndOfCentralDirectoryLocatorSize;
+		if (readLong(locator) != (unsigned long)ZLZipHeader::SignatureZip64EndOfCentralDirectoryLocator) {
+			return false;
+		}
+		const std::size_t locatorOffset = directoryEnd - Zip64EndOfCentralDirectoryLocatorSize;
+		if (locatorOffset < Zip64EndOfCentralDirectorySize) {
+			return false;
+		}
+		uint64_t zip64Offset = readLongLong(locator + 8);
+		char zip64Record[Zip64EndOfCentralDirectorySize];
+		if (zip64Offset + Zip64EndOfCentralDirectorySize > locatorOffset ||
+				!readAt(containerStream, zip64Offset, zip64Record, Zip64EndOfCentralDirectorySize) ||
+				readLong(zip64Record) != (unsigned long)ZLZipHeader::SignatureZip64EndOfCentralDirectory) {
+			// the recorded offset does not count data prepended to the archive;
+			// without an extensible data sector the record precedes the locator
+			zip64Offset = locatorOffset - Zip64EndOfCentralDirectorySize;
+			if (!readAt(containerStream, zip64Offset, zip64Record, Zip64EndOfCentralDirectorySize) ||
+					readLong(zip64Record) != (unsigned long)ZLZipHeader::SignatureZip64EndOfCentralDirectory) {
+				return false;
+			}
+		}
+		entryCount = readLongLong(zip64Record + 32);
+		directorySize = readLongLong(zip64Record + 40);
+		directoryOffset = readLongLong(zip64Record + 48);
+		directoryEnd = zip64Offset;
+	}
+
+	if (directorySize > directoryEnd || directoryEnd - directorySize < directoryOffset) {
+		return false;
+	}
+	const std::size_t directoryStart = directoryEnd - directorySize;
+	// non-zero if something (e.g. a self-extractor) is prepended to the archive
+	const std::size_t shift = directoryStart - directoryOffset;
+
+	std::string directory(directorySize, '\0');
+	if (!readAt(containerStream, directoryStart, (char*)directory.data(), directorySize)) {
+		return false;
+	}
+
+	uint64_t counter = 0;
+	const char *ptr = directory.data();
+	const char *end = ptr + directory.size();
+	for (; ptr + CentralDirectoryHeaderSize <= end; ++counter) {
+		if (readLong(ptr) != (unsigned long)ZLZipHeader::SignatureCentralDirectory) {
+			break;
+		}
+		const unsigned short compressionMethod = readShort(ptr + 10);
+		uint64_t compressedSize = readLong(ptr + 20);
+		uint64_t uncompressedSize = readLong(ptr + 24);
+		const unsigned short nameLength = readShort(ptr + 28);
+		const unsigned short extraLength = readShort(ptr + 30);
+		const unsigned short commentLength = readShort(ptr + 32);
+		uint64_t headerOffset = readLong(ptr + 42);
+
+		const char *name = ptr + CentralDirectoryHeaderSize;
+		const char *extra = name + nameLength;
+		ptr = extra + extraLength + commentLength;
+		if (ptr > end) {
+			return false;
+		}
+		readZip64Extra(extra, extraLength, uncompressedSize, compressedSize, headerOffset);
+		headerOffset += shift;
+
+		if (nameLength == 0) {
+			continue;
+		}
+		if (headerOffset > (uint64_t)INT_MAX || compressedSize > (uint64_t)INT_MAX || uncompressedSize > (uint64_t)INT_MAX) {
+			ZLLOG("zip", "Entry is too large, skipped: " + std::string(name, nameLength));
+			continue;
+		}
+		if (compressionMethod == 0 && compressedSize != uncompressedSize) {
+			ZLLOG("zip", "Different compressed & uncompressed size for stored entry; the uncompressed one will be used.");
+			compressedSize = uncompressedSize;
+		}
+
+		Info &info = myInfoMap[AndroidUtil::convertNonUtfString(std::string(name, nameLength))];
+		info.HeaderOffset = headerOffset;
+		info.CompressionMethod = compressionMethod;
+		info.CompressedSize = compressedSize;
+		info.UncompressedSize = uncompressedSize;
+	}
+	return counter == entryCount;
+}
+
+void ZLZipEntryCache::readLocalHeaders(ZLInputStream &containerStream) {
 	ZLZipHeader header;
 	while (header.readFrom(containerStream)) {
 		Info *infoPtr = 0;
@@ -72,7 +467,6 @@ ZLZipEntryCache::ZLZipEntryCache(const std::string &containerName, ZLInputStream
 			infoPtr->UncompressedSize = header.UncompressedSize;
 		}
 	}
-	containerStream.close();
 }
 
 ZLZipEntryCache::Info ZLZipEntryCache::info(const std::string &entryName) const {
@@ -85,3 +479,12 @@ void ZLZipEntryCache::collectFileNames(std::vector<std::string> &names) const {
 		names.push_back(it->first);
 	}
 }
+
+std::size_t ZLZipEntryCache::memorySize() const {
+	// rough estimate: map node overhead is about 16 bytes plus string headers
+	std::size_t size = sizeof(ZLZipEntryCache) + myContainerName.length();
+	for (std::map<std::string,Info>::const_iterator it = myInfoMap.begin(); it != myInfoMap.end(); ++it) {
+		size += sizeof(*it) + 16 + it->first.length();
+	}
+	return size;
+}
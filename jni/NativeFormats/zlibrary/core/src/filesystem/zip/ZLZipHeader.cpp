@@ -27,6 +27,8 @@ const int ZLZipHeader::SignatureCentralDirectory = 0x02014B50;
 const int ZLZipHeader::SignatureLocalFile = 0x04034B50;
 const int ZLZipHeader::SignatureEndOfCentralDirectory = 0x06054B50;
 const int ZLZipHeader::SignatureData = 0x08074B50;
+const int ZLZipHeader::SignatureZip64EndOfCentralDirectory = 0x06064B50;
+const int ZLZipHeader::SignatureZip64EndOfCentralDirectoryLocator = 0x07064B50;
 
 bool ZLZipHeader::readFrom(ZLInputStream &stream) {
 	std::size_t startOffset = stream.offset();
@@ -45,7 +47,7 @@ bool ZLZipHeader::readFrom(ZLInputStream &stream) {
 			CompressedSize = readLong(stream);
 			UncompressedSize = readLong(stream);
 			if (CompressionMethod == 0 && CompressedSize != UncompressedSize) {
-				ZLLogger::Instance().println("zip", "Different compressed & uncompressed size for stored entry; the uncompressed one will be used.");
+				ZLLOG("zip", "Different compressed & uncompressed size for stored entry; the uncompressed one will be used.");
 				CompressedSize = UncompressedSize;
 			}
 			NameLength = readShort(stream);
@@ -64,7 +66,7 @@ bool ZLZipHeader::readFrom(ZLInputStream &stream) {
 			CompressedSize = readLong(stream);
 			UncompressedSize = readLong(stream);
 			if (CompressionMethod == 0 && CompressedSize != UncompressedSize) {
-				ZLLogger::Instance().println("zip", "Different compressed & uncompressed size for stored entry; the uncompressed one will be used.");
+				ZLLOG("zip", "Different compressed & uncompressed size for stored entry; the uncompressed one will be used.");
 				CompressedSize = UncompressedSize;
 			}
 			NameLength = readShort(stream);
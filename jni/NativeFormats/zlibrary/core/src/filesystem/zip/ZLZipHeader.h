@@ -27,6 +27,8 @@ struct ZLZipHeader {
 	static const int SignatureData;
 	static const int SignatureCentralDirectory;
 	static const int SignatureEndOfCentralDirectory;
+	static const int SignatureZip64EndOfCentralDirectory;
+	static const int SignatureZip64EndOfCentralDirectoryLocator;
 
 	unsigned long Signature;
 	unsigned short Version;
@@ -34,17 +34,28 @@ ZLZipInputStream::~ZLZipInputStream() {
 bool ZLZipInputStream::open() {
 	close();
 
-	ZLZipEntryCache::Info info = ZLZipEntryCache::cache(myBaseName, *myBaseStream)->info(myEntryName);
+	ZLZipEntryCache::Info info = ZLZipEntryCache::info(myBaseName, *myBaseStream, myEntryName);
 
 	if (!myBaseStream->open()) {
 		return false;
 	}
 
-	if (info.Offset == -1) {
+	if (!info.exists()) {
 		close();
 		return false;
 	}
-	myBaseStream->seek(info.Offset, true);
+	if (info.Offset != -1) {
+		myBaseStream->seek(info.Offset, true);
+	} else {
+		myBaseStream->seek(info.HeaderOffset, true);
+		ZLZipHeader header;
+		if (!header.readFrom(*myBaseStream) ||
+				header.Signature != (unsigned long)ZLZipHeader::SignatureLocalFile) {
+			close();
+			return false;
+		}
+		myBaseStream->seek(header.NameLength + header.ExtraLength, false);
+	}
 
 	if (info.CompressionMethod == 0) {
 		myIsDeflated = false;
@@ -55,24 +66,67 @@ bool ZLZipInputStream::open() {
 		return false;
 	}
 	myUncompressedSize = info.UncompressedSize;
-	myAvailableSize = info.CompressedSize;
-	if (myAvailableSize == 0) {
-		myAvailableSize = (std::size_t)-1;
+	myCompressedSize = info.CompressedSize;
+	if (myCompressedSize == 0) {
+		myCompressedSize = (std::size_t)-1;
 	}
+	myAvailableSize = myCompressedSize;
+	myDataOffset = myBaseStream->offset();
 
 	if (myIsDeflated) {
-		myDecompressor = new ZLZDecompressor(myAvailableSize);
+		createDecompressor(0);
 	}
 
 	myOffset = 0;
 	return true;
 }
 
+void ZLZipInputStream::createDecompressor(std::size_t compressedOffset) {
+	myDecompressor = new ZLZDecompressor(
+		myCompressedSize == (std::size_t)-1 ? myCompressedSize : myCompressedSize - compressedOffset
+	);
+	if (myUncompressedSize > ZLZDecompressor::CheckpointSpacing) {
+		collectCheckpoints();
+	}
+}
+
+void ZLZipInputStream::collectCheckpoints() {
+	std::size_t spacing;
+	const std::size_t offset = ZLZipEntryCache::nextCheckpointOffset(myBaseName, myEntryName, spacing);
+	myDecompressor->collectCheckpoints(offset, spacing);
+}
+
+bool ZLZipInputStream::restoreCheckpoint(std::size_t offset) {
+	ZLInflateCheckpoint checkpoint;
+	if (!ZLZipEntryCache::findCheckpoint(myBaseName, myEntryName, offset, checkpoint)) {
+		return false;
+	}
+	if (offset >= myOffset && checkpoint.OutputOffset <= myOffset) {
+		// going on from the current position is not slower
+		return false;
+	}
+	myBaseStream->seek(myDataOffset + checkpoint.InputOffset, true);
+	createDecompressor(checkpoint.InputOffset);
+	if (!myDecompressor->restore(checkpoint)) {
+		open();
+		return false;
+	}
+	myOffset = checkpoint.OutputOffset;
+	return true;
+}
+
 std::size_t ZLZipInputStream::read(char *buffer, std::size_t maxSize) {
 	std::size_t realSize = 0;
 	if (myIsDeflated) {
 		realSize = myDecompressor->decompress(*myBaseStream, buffer, maxSize);
 		myOffset += realSize;
+		std::vector<ZLInflateCheckpoint> checkpoints;
+		myDecompressor->takeCheckpoints(checkpoints);
+		if (!checkpoints.empty()) {
+			ZLZipEntryCache::addCheckpoints(myBaseName, myEntryName, checkpoints);
+			// the stored checkpoints may have been thinned
+			collectCheckpoints();
+		}
 	} else {
 		realSize = myBaseStream->read(buffer, std::min(maxSize, myAvailableSize));
 		myAvailableSize -= realSize;
@@ -89,9 +143,14 @@ void ZLZipInputStream::close() {
 }
 
 void ZLZipInputStream::seek(int offset, bool absoluteOffset) {
-	if (absoluteOffset) {
-		offset -= this->offset();
+	if (!absoluteOffset) {
+		offset += this->offset();
+	}
+	if (offset >= 0 && myIsDeflated && restoreCheckpoint(offset)) {
+		read(0, offset - myOffset);
+		return;
 	}
+	offset -= this->offset();
 	if (offset > 0) {
 		read(0, offset);
 	} else if (offset < 0) {
@@ -110,3 +169,14 @@ std::size_t ZLZipInputStream::offset() const {
 std::size_t ZLZipInputStream::sizeOfOpened() {
 	return myUncompressedSize;
 }
+
+const char *ZLZipInputStream::borrow(std::size_t &size) {
+	if (myIsDeflated || myBaseStream.isNull()) {
+		size = 0;
+		return 0;
+	}
+	// stored entries are lent by the archive stream as they are
+	const char *data = myBaseStream->borrow(size);
+	size = std::min(size, myAvailableSize);
+	return data;
+}
@@ -63,30 +63,26 @@ static std::string naiveEncodingDetection(const unsigned char *buffer, std::size
 		return ZLEncodingConverter::UTF16;
 	}
 
-	bool ascii = true;
-	const unsigned char *end = buffer + length;
-	int utf8count = 0;
-	for (const unsigned char *ptr = buffer; ptr < end; ++ptr) {
-		if (utf8count > 0) {
-			if ((*ptr & 0xc0) != 0x80) {
-				return std::string();
-			}
-			--utf8count;
-		} else if ((*ptr & 0x80) == 0) {
-		} else if ((*ptr & 0xe0) == 0xc0) {
-			ascii = false;
-			utf8count = 1;
-		} else if ((*ptr & 0xf0) == 0xe0) {
-			ascii = false;
-			utf8count = 2;
-		} else if ((*ptr & 0xf8) == 0xf0) {
-			ascii = false;
-			utf8count = 3;
-		} else {
-			return std::string();
+	const char *data = (const char*)buffer;
+	if (ZLUnicodeUtil::asciiLength(data, length) == length) {
+		return ZLEncodingConverter::ASCII;
+	}
+
+	// the buffer is a prefix of the text, so the last character may be cut
+	std::size_t validLength = length;
+	for (std::size_t tail = 0; tail < 3 && tail < length; ++tail) {
+		const unsigned char ch = buffer[length - tail - 1];
+		if ((ch & 0xc0) == 0x80) {
+			continue;
+		}
+		if (((ch & 0xe0) == 0xc0 && tail < 1) ||
+				((ch & 0xf0) == 0xe0 && tail < 2) ||
+				((ch & 0xf8) == 0xf0 && tail < 3)) {
+			validLength = length - tail - 1;
 		}
+		break;
 	}
-	return ascii ? ZLEncodingConverter::ASCII : ZLEncodingConverter::UTF8;
+	return ZLUnicodeUtil::isUtf8String(data, validLength) ? ZLEncodingConverter::UTF8 : std::string();
 }
 
 shared_ptr<ZLLanguageDetector::LanguageInfo> ZLLanguageDetector::findInfo(const char *buffer, std::size_t length, int matchingCriterion) {
@@ -25,6 +25,11 @@ const std::string ZLLogger::DEFAULT_CLASS;
 
 ZLLogger *ZLLogger::ourInstance = 0;
 
+pthread_mutex_t ZLLogger::ourClassBitsMutex = PTHREAD_MUTEX_INITIALIZER;
+std::map<std::string,uint32_t> ZLLogger::ourClassBits;
+// the default class is always enabled
+volatile uint32_t ZLLogger::ourEnabledClasses = 1;
+
 ZLLogger &ZLLogger::Instance() {
 	if (ourInstance == 0) {
 		ourInstance = new ZLLogger();
@@ -35,22 +40,34 @@ ZLLogger &ZLLogger::Instance() {
 ZLLogger::ZLLogger() {
 }
 
+uint32_t ZLLogger::classBit(const std::string &className) {
+	if (className == DEFAULT_CLASS) {
+		return 1;
+	}
+	pthread_mutex_lock(&ourClassBitsMutex);
+	std::map<std::string,uint32_t>::const_iterator it = ourClassBits.find(className);
+	uint32_t bit;
+	if (it != ourClassBits.end()) {
+		bit = it->second;
+	} else {
+		bit = ourClassBits.size() < 30 ? (uint32_t)2 << ourClassBits.size() : (uint32_t)1 << 31;
+		ourClassBits.insert(std::make_pair(className, bit));
+	}
+	pthread_mutex_unlock(&ourClassBitsMutex);
+	return bit;
+}
+
 void ZLLogger::registerClass(const std::string &className) {
 	myRegisteredClasses.insert(className);
+	__sync_fetch_and_or(&ourEnabledClasses, classBit(className));
 }
 
 void ZLLogger::print(const std::string &className, const std::string &message) const {
-	std::string m = message;
-	for (std::size_t index = m.find('%'); index != std::string::npos; index = m.find('%', index + 2)) {
-		m.replace(index, 1, "%%");
-	}
-	if (className == DEFAULT_CLASS) {
-		__android_log_print(ANDROID_LOG_WARN, "ZLLogger", "%s", m.c_str());
-	} else {
-		if (myRegisteredClasses.find(className) != myRegisteredClasses.end()) {
-			__android_log_print(ANDROID_LOG_WARN, className.c_str(), "%s", m.c_str());
-		}
+	if (className != DEFAULT_CLASS && myRegisteredClasses.find(className) == myRegisteredClasses.end()) {
+		return;
 	}
+	// the message is passed as an argument, so '%' needs no escaping
+	__android_log_print(ANDROID_LOG_WARN, className == DEFAULT_CLASS ? "ZLLogger" : className.c_str(), "%s", message.c_str());
 }
 
 void ZLLogger::println(const std::string &className, const std::string &message) const {
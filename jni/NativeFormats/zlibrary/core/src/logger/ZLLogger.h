@@ -20,8 +20,35 @@
 #ifndef __ZLLOGGER_H__
 #define __ZLLOGGER_H__
 
+#include <stdint.h>
+#include <pthread.h>
+
 #include <string>
 #include <set>
+#include <map>
+
+// The message is evaluated only if the class is registered;
+// the check is a single bit test after the first call at the call site.
+#define ZLLOG(className, message) \
+	do { \
+		static const uint32_t zlLoggerClassBit = ZLLogger::classBit(className); \
+		if (ZLLogger::isEnabled(zlLoggerClassBit)) { \
+			ZLLogger::Instance().println(className, message); \
+		} \
+	} while (0)
+
+// Debug classes are compiled out unless ZLLOGGER_DEBUG is defined, see
+// Android.mk; the dead call keeps the arguments checked by the compiler
+#ifdef ZLLOGGER_DEBUG
+#define ZLLOG_DEBUG(className, message) ZLLOG(className, message)
+#else
+#define ZLLOG_DEBUG(className, message) \
+	do { \
+		if (false) { \
+			ZLLogger::Instance().println(className, message); \
+		} \
+	} while (0)
+#endif
 
 class ZLLogger {
 
@@ -30,9 +57,18 @@ public:
 
 	static ZLLogger &Instance();
 
+	// every class name gets its own bit; when there are no free bits
+	// left, the last one is shared by all the remaining classes
+	static uint32_t classBit(const std::string &className);
+	static bool isEnabled(uint32_t classBit);
+
 private:
 	static ZLLogger *ourInstance;
 
+	static pthread_mutex_t ourClassBitsMutex;
+	static std::map<std::string,uint32_t> ourClassBits;
+	static volatile uint32_t ourEnabledClasses;
+
 private:
 	ZLLogger();
 
@@ -45,4 +81,6 @@ private:
 	std::set<std::string> myRegisteredClasses;
 };
 
+inline bool ZLLogger::isEnabled(uint32_t classBit) { return (ourEnabledClasses & classBit) != 0; }
+
 #endif /* __ZLLOGGER_H__ */
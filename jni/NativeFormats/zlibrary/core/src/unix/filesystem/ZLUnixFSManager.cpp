@@ -29,8 +29,12 @@
 #include "ZLUnixFSManager.h"
 #include "ZLUnixFSDir.h"
 #include "ZLUnixFileInputStream.h"
+#include "ZLUnixMappedFileInputStream.h"
 #include "ZLUnixFileOutputStream.h"
 
+// smaller files are read through stdio; mapping them costs more than it saves
+static const off_t MAPPING_THRESHOLD = 64 * 1024;
+
 static std::string getPwdDir() {
 	char *pwd = getenv("PWD");
 	return (pwd != 0) ? pwd : "";
@@ -47,6 +51,7 @@ ZLFileInfo ZLUnixFSManager::fileInfo(const std::string &path) const {
 	info.Exists = stat(path.c_str(), &fileStat) == 0;
 	if (info.Exists) {
 		info.Size = fileStat.st_size;
+		info.LastModified = fileStat.st_mtime;
 		info.IsDirectory = S_ISDIR(fileStat.st_mode);
 	}
 	return info;
@@ -156,6 +161,15 @@ ZLInputStream *ZLUnixFSManager::createPlainInputStream(const std::string &path)
 	return new ZLUnixFileInputStream(path);
 }
 
+ZLInputStream *ZLUnixFSManager::createMappedInputStream(const std::string &path) const {
+	struct stat fileStat;
+	if (stat(path.c_str(), &fileStat) == 0 &&
+			S_ISREG(fileStat.st_mode) && fileStat.st_size >= MAPPING_THRESHOLD) {
+		return new ZLUnixMappedFileInputStream(path);
+	}
+	return createPlainInputStream(path);
+}
+
 ZLOutputStream *ZLUnixFSManager::createOutputStream(const std::string &path) const {
 	return new ZLUnixFileOutputStream(path);
 }
@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2004-2014 Geometer Plus <contact@geometerplus.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include <algorithm>
+#include <list>
+#include <map>
+
+#include "ZLUnixMappedFileInputStream.h"
+#include "ZLUnixFileInputStream.h"
+
+struct ZLFileMapping {
+	std::string Name;
+	char *Data;
+	std::size_t Size;
+	long LastModified;
+	ino_t Inode;
+	int Users;
+	bool IsSequential;
+	// is false for a mapping of a file that has changed since
+	bool IsCurrent;
+	// valid when Users == 0
+	std::list<ZLFileMapping*>::iterator UnusedPosition;
+};
+
+// unused mappings are kept while they take less address space than this
+static const std::size_t UNUSED_MAPPINGS_BUDGET = 64 * 1024 * 1024;
+
+static pthread_mutex_t ourMutex = PTHREAD_MUTEX_INITIALIZER;
+static std::map<std::string,ZLFileMapping*> ourMappings;
+// most recently released first
+static std::list<ZLFileMapping*> ourUnusedMappings;
+static std::size_t ourUnusedSize = 0;
+
+class ZLFileMappingLock {
+
+public:
+	ZLFileMappingLock();
+	~ZLFileMappingLock();
+};
+
+ZLFileMappingLock::ZLFileMappingLock() {
+	pthread_mutex_lock(&ourMutex);
+}
+
+ZLFileMappingLock::~ZLFileMappingLock() {
+	pthread_mutex_unlock(&ourMutex);
+}
+
+// the next three functions are called with the lock held
+static void unmapFile(ZLFileMapping *mapping) {
+	munmap(mapping->Data, mapping->Size);
+	delete mapping;
+}
+
+static void removeUnused(ZLFileMapping *mapping) {
+	ourUnusedMappings.erase(mapping->UnusedPosition);
+	ourUnusedSize -= mapping->Size;
+}
+
+static ZLFileMapping *mapFile(const std::string &name) {
+	const int fd = ::open(name.c_str(), O_RDONLY);
+	if (fd == -1) {
+		return 0;
+	}
+	ZLFileMapping *mapping = 0;
+	struct stat fileStat;
+	// st_size is 64-bit with large file support; files
+	// that do not fit into the address space are not mapped
+	if (fstat(fd, &fileStat) == 0 && S_ISREG(fileStat.st_mode) && fileStat.st_size > 0 &&
+			(unsigned long long)fileStat.st_size <= (unsigned long long)(std::size_t)-1) {
+		void *data = mmap(0, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data != MAP_FAILED) {
+			madvise(data, fileStat.st_size, MADV_SEQUENTIAL);
+			mapping = new ZLFileMapping();
+			mapping->Name = name;
+			mapping->Data = (char*)data;
+			mapping->Size = fileStat.st_size;
+			mapping->LastModified = fileStat.st_mtime;
+			mapping->Inode = fileStat.st_ino;
+			mapping->Users = 1;
+			mapping->IsSequential = true;
+			mapping->IsCurrent = true;
+		}
+	}
+	// the mapping stays valid after the descriptor is closed
+	::close(fd);
+	return mapping;
+}
+
+static ZLFileMapping *acquireMapping(const std::string &name) {
+	struct stat fileStat;
+	if (stat(name.c_str(), &fileStat) != 0) {
+		return 0;
+	}
+
+	ZLFileMappingLock lock;
+	std::map<std::string,ZLFileMapping*>::iterator it = ourMappings.find(name);
+	if (it != ourMappings.end()) {
+		ZLFileMapping *mapping = it->second;
+		if ((unsigned long long)mapping->Size == (unsigned long long)fileStat.st_size &&
+				mapping->LastModified == fileStat.st_mtime &&
+				mapping->Inode == fileStat.st_ino) {
+			if (mapping->Users++ == 0) {
+				removeUnused(mapping);
+			}
+			return mapping;
+		}
+		ourMappings.erase(it);
+		if (mapping->Users == 0) {
+			removeUnused(mapping);
+			unmapFile(mapping);
+		} else {
+			// is unmapped when the last stream is closed
+			mapping->IsCurrent = false;
+		}
+	}
+
+	ZLFileMapping *mapping = mapFile(name);
+	if (mapping != 0) {
+		ourMappings[name] = mapping;
+	}
+	return mapping;
+}
+
+static void releaseMapping(ZLFileMapping *mapping) {
+	ZLFileMappingLock lock;
+	if (--mapping->Users > 0) {
+		return;
+	}
+	if (!mapping->IsCurrent) {
+		unmapFile(mapping);
+		return;
+	}
+	ourUnusedMappings.push_front(mapping);
+	mapping->UnusedPosition = ourUnusedMappings.begin();
+	ourUnusedSize += mapping->Size;
+	while (ourUnusedSize > UNUSED_MAPPINGS_BUDGET) {
+		ZLFileMapping *oldest = ourUnusedMappings.back();
+		removeUnused(oldest);
+		ourMappings.erase(oldest->Name);
+		unmapFile(oldest);
+	}
+}
+
+static void adviseRandomAccess(ZLFileMapping *mapping) {
+	ZLFileMappingLock lock;
+	if (mapping->IsSequential) {
+		mapping->IsSequential = false;
+		// read-ahead of the whole file would be a waste
+		madvise(mapping->Data, mapping->Size, MADV_NORMAL);
+	}
+}
+
+ZLUnixMappedFileInputStream::ZLUnixMappedFileInputStream(const std::string &name) : myName(name), myMapping(0), myOffset(0), myIsSequential(true) {
+}
+
+ZLUnixMappedFileInputStream::~ZLUnixMappedFileInputStream() {
+	close();
+}
+
+bool ZLUnixMappedFileInputStream::open() {
+	if (myMapping != 0) {
+		myOffset = 0;
+		return true;
+	}
+	if (!myFallbackStream.isNull()) {
+		return myFallbackStream->open();
+	}
+
+	myMapping = acquireMapping(myName);
+	if (myMapping == 0) {
+		myFallbackStream = new ZLUnixFileInputStream(myName);
+		return myFallbackStream->open();
+	}
+	myOffset = 0;
+	myIsSequential = true;
+	return true;
+}
+
+std::size_t ZLUnixMappedFileInputStream::read(char *buffer, std::size_t maxSize) {
+	if (!myFallbackStream.isNull()) {
+		return myFallbackStream->read(buffer, maxSize);
+	}
+	if (myMapping == 0) {
+		return 0;
+	}
+	const std::size_t size = std::min(maxSize, myMapping->Size - myOffset);
+	if (buffer != 0) {
+		std::memcpy(buffer, myMapping->Data + myOffset, size);
+	}
+	myOffset += size;
+	return size;
+}
+
+void ZLUnixMappedFileInputStream::close() {
+	if (myMapping != 0) {
+		releaseMapping(myMapping);
+		myMapping = 0;
+		myOffset = 0;
+	}
+	if (!myFallbackStream.isNull()) {
+		myFallbackStream->close();
+		myFallbackStream = 0;
+	}
+}
+
+void ZLUnixMappedFileInputStream::seek(int offset, bool absoluteOffset) {
+	if (!myFallbackStream.isNull()) {
+		myFallbackStream->seek(offset, absoluteOffset);
+		return;
+	}
+	if (myMapping == 0) {
+		return;
+	}
+	std::size_t position = absoluteOffset ? 0 : myOffset;
+	if (offset >= 0) {
+		position = std::min(position + offset, myMapping->Size);
+	} else {
+		position -= std::min(position, 0 - (std::size_t)offset);
+	}
+	if (position < myOffset && myIsSequential) {
+		myIsSequential = false;
+		adviseRandomAccess(myMapping);
+	}
+	myOffset = position;
+}
+
+std::size_t ZLUnixMappedFileInputStream::offset() const {
+	if (!myFallbackStream.isNull()) {
+		return myFallbackStream->offset();
+	}
+	return myOffset;
+}
+
+std::size_t ZLUnixMappedFileInputStream::sizeOfOpened() {
+	if (!myFallbackStream.isNull()) {
+		return myFallbackStream->sizeOfOpened();
+	}
+	return myMapping != 0 ? myMapping->Size : 0;
+}
+
+const char *ZLUnixMappedFileInputStream::borrow(std::size_t &size) {
+	if (myMapping == 0) {
+		size = 0;
+		return 0;
+	}
+	size = myMapping->Size - myOffset;
+	return myMapping->Data + myOffset;
+}
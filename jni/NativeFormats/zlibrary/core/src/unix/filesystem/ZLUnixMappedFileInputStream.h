@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2004-2014 Geometer Plus <contact@geometerplus.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef __ZLUNIXMAPPEDFILEINPUTSTREAM_H__
+#define __ZLUNIXMAPPEDFILEINPUTSTREAM_H__
+
+#include <ZLInputStream.h>
+
+struct ZLFileMapping;
+
+// reads the file through a read-only memory mapping; the mapping is shared
+// by all the streams of the file, and is kept for a while after the last
+// stream is closed; falls back to ZLUnixFileInputStream if mapping fails;
+// created by ZLFile::mappedInputStream() only: touching the mapping past
+// the end of a file truncated in place raises SIGBUS
+class ZLUnixMappedFileInputStream : public ZLInputStream {
+
+public:
+	ZLUnixMappedFileInputStream(const std::string &name);
+	~ZLUnixMappedFileInputStream();
+	bool open();
+	std::size_t read(char *buffer, std::size_t maxSize);
+	void close();
+
+	void seek(int offset, bool absoluteOffset);
+	std::size_t offset() const;
+	std::size_t sizeOfOpened();
+
+	const char *borrow(std::size_t &size);
+
+private:
+	std::string myName;
+	ZLFileMapping *myMapping;
+	std::size_t myOffset;
+	bool myIsSequential;
+	shared_ptr<ZLInputStream> myFallbackStream;
+};
+
+#endif /* __ZLUNIXMAPPEDFILEINPUTSTREAM_H__ */
@@ -18,8 +18,16 @@
  */
 
 #include <cstdlib>
+#include <cstring>
 #include <map>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ZL_UNICODE_NEON
+#endif
+
 #include <AndroidUtil.h>
 #include <JniEnvelope.h>
 
@@ -28,6 +36,7 @@
 #include <ZLXMLReader.h>
 
 #include "ZLUnicodeUtil.h"
+#include "ZLUnicodeCaseTables.h"
 
 struct ZLUnicodeData {
 	enum SymbolType {
@@ -91,21 +100,89 @@ static void initUnicodeTable() {
 }
 */
 
+// the high bit of every byte of a machine word
+static const unsigned long NON_ASCII_MASK = ~0UL / 0xFF * 0x80;
+
+std::size_t ZLUnicodeUtil::asciiLength(const char *str, std::size_t len) {
+	const char *ptr = str;
+	const char *last = str + len;
+#if defined(__SSE2__)
+	for (; last - ptr >= 16; ptr += 16) {
+		const int mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)ptr));
+		if (mask != 0) {
+			return ptr - str + __builtin_ctz(mask);
+		}
+	}
+#elif defined(ZL_UNICODE_NEON)
+	for (; last - ptr >= 16; ptr += 16) {
+		const uint8x16_t bytes = vld1q_u8((const uint8_t*)ptr);
+		const uint8x8_t folded = vorr_u8(vget_low_u8(bytes), vget_high_u8(bytes));
+		if ((vget_lane_u64(vreinterpret_u64_u8(folded), 0) & 0x8080808080808080ULL) != 0) {
+			break;
+		}
+	}
+#endif
+	for (; (std::size_t)(last - ptr) >= sizeof(unsigned long); ptr += sizeof(unsigned long)) {
+		unsigned long word;
+		std::memcpy(&word, ptr, sizeof(unsigned long));
+		if ((word & NON_ASCII_MASK) != 0) {
+			break;
+		}
+	}
+	while (ptr < last && (*ptr & 0x80) == 0) {
+		++ptr;
+	}
+	return ptr - str;
+}
+
+// *ptr is ASCII; a single ASCII byte between letters (a space, say)
+// is common in non-Latin texts and is not worth a block scan
+static inline std::size_t asciiRunLength(const char *ptr, const char *last) {
+	if (last - ptr < 2 || (ptr[1] & 0x80) != 0) {
+		return 1;
+	}
+	return ZLUnicodeUtil::asciiLength(ptr, last - ptr);
+}
+
+// count bytes are known to be ASCII
+static void asciiToUcs2(ZLUnicodeUtil::Ucs2Char *to, const char *from, std::size_t count) {
+	const char *last = from + count;
+#if defined(__SSE2__)
+	const __m128i zero = _mm_setzero_si128();
+	for (; last - from >= 16; from += 16, to += 16) {
+		const __m128i bytes = _mm_loadu_si128((const __m128i*)from);
+		_mm_storeu_si128((__m128i*)to, _mm_unpacklo_epi8(bytes, zero));
+		_mm_storeu_si128((__m128i*)(to + 8), _mm_unpackhi_epi8(bytes, zero));
+	}
+#elif defined(ZL_UNICODE_NEON)
+	for (; last - from >= 16; from += 16, to += 16) {
+		const uint8x16_t bytes = vld1q_u8((const uint8_t*)from);
+		vst1q_u16(to, vmovl_u8(vget_low_u8(bytes)));
+		vst1q_u16(to + 8, vmovl_u8(vget_high_u8(bytes)));
+	}
+#endif
+	while (from < last) {
+		*to++ = *from++;
+	}
+}
+
 bool ZLUnicodeUtil::isUtf8String(const char *str, int len) {
 	const char *last = str + len;
 	int nonLeadingCharsCounter = 0;
-	for (; str < last; ++str) {
+	while (str < last) {
 		if (nonLeadingCharsCounter == 0) {
-			if ((*str & 0x80) != 0) {
-				if ((*str & 0xE0) == 0xC0) {
-					nonLeadingCharsCounter = 1;
-				} else if ((*str & 0xF0) == 0xE0) {
-					nonLeadingCharsCounter = 2;
-				} else if ((*str & 0xF8) == 0xF0) {
-					nonLeadingCharsCounter = 3;
-				} else {
-					return false;
-				}
+			if ((*str & 0x80) == 0) {
+				str += asciiRunLength(str, last);
+				continue;
+			}
+			if ((*str & 0xE0) == 0xC0) {
+				nonLeadingCharsCounter = 1;
+			} else if ((*str & 0xF0) == 0xE0) {
+				nonLeadingCharsCounter = 2;
+			} else if ((*str & 0xF8) == 0xF0) {
+				nonLeadingCharsCounter = 3;
+			} else {
+				return false;
 			}
 		} else {
 			if ((*str & 0xC0) != 0x80) {
@@ -113,6 +190,7 @@ bool ZLUnicodeUtil::isUtf8String(const char *str, int len) {
 			}
 			--nonLeadingCharsCounter;
 		}
+		++str;
 	}
 	return nonLeadingCharsCounter == 0;
 }
@@ -161,7 +239,10 @@ int ZLUnicodeUtil::utf8Length(const char *str, int len) {
 	int counter = 0;
 	while (str < last) {
 		if ((*str & 0x80) == 0) {
-			++str;
+			const std::size_t ascii = asciiRunLength(str, last);
+			str += ascii;
+			counter += ascii;
+			continue;
 		} else if ((*str & 0x20) == 0) {
 			str += 2;
 		} else if ((*str & 0x10) == 0) {
@@ -238,44 +319,59 @@ void ZLUnicodeUtil::utf8ToUcs4(Ucs4String &to, const std::string &from, int toLe
 	utf8ToUcs4(to, from.data(), from.length(), toLength);
 }
 
-void ZLUnicodeUtil::utf8ToUcs2(Ucs2String &to, const char *from, int length, int toLength) {
+void ZLUnicodeUtil::utf8ToUcs2(Ucs2String &to, const char *from, int length, int /*toLength*/) {
 	to.clear();
-	if (toLength < 0) {
-		toLength = utf8Length(from, length);
+	if (length <= 0) {
+		return;
 	}
-	to.reserve(toLength);
+	// there are no more characters than bytes
+	to.resize(length);
+	to.resize(utf8ToUcs2(&to.front(), from, length));
+}
+
+void ZLUnicodeUtil::utf8ToUcs2(Ucs2String &to, const std::string &from, int toLength) {
+	utf8ToUcs2(to, from.data(), from.length(), toLength);
+}
+
+std::size_t ZLUnicodeUtil::utf8ToUcs2(Ucs2Char *to, const char *from, std::size_t length) {
+	Ucs2Char *start = to;
 	const char *last = from + length;
-	for (const char *ptr = from; ptr < last;) {
-		if ((*ptr & 0x80) == 0) {
-			to.push_back(*ptr);
-			++ptr;
-		} else if ((*ptr & 0x20) == 0) {
-			Ucs2Char ch = *ptr & 0x1f;
-			++ptr;
+	const char *ptr = from;
+	while (ptr < last) {
+		// bytes missing at the end count as zeros
+		const unsigned char lead = *ptr;
+		if ((lead & 0x80) == 0) {
+			const std::size_t ascii = asciiRunLength(ptr, last);
+			asciiToUcs2(to, ptr, ascii);
+			to += ascii;
+			ptr += ascii;
+		} else if ((lead & 0x20) == 0) {
+			Ucs2Char ch = lead & 0x1f;
 			ch <<= 6;
-			ch += *ptr & 0x3f;
-			to.push_back(ch);
-			++ptr;
-		} else if ((*ptr & 0x10) == 0) {
-			Ucs2Char ch = *ptr & 0x0f;
-			++ptr;
+			if (last - ptr > 1) {
+				ch += ptr[1] & 0x3f;
+			}
+			*to++ = ch;
+			ptr += 2;
+		} else if ((lead & 0x10) == 0) {
+			Ucs2Char ch = lead & 0x0f;
 			ch <<= 6;
-			ch += *ptr & 0x3f;
-			++ptr;
+			if (last - ptr > 1) {
+				ch += ptr[1] & 0x3f;
+			}
 			ch <<= 6;
-			ch += *ptr & 0x3f;
-			to.push_back(ch);
-			++ptr;
+			if (last - ptr > 2) {
+				ch += ptr[2] & 0x3f;
+			}
+			*to++ = ch;
+			ptr += 3;
 		} else {
 			// symbol number is > 0xffff :(
-			to.push_back('X');
+			*to++ = 'X';
 			ptr += 4;
 		}
 	}
-}
-
-void ZLUnicodeUtil::utf8ToUcs2(Ucs2String &to, const std::string &from, int toLength) {
-	utf8ToUcs2(to, from.data(), from.length(), toLength);
+	return to - start;
 }
 
 std::size_t ZLUnicodeUtil::firstChar(Ucs4Char &ch, const std::string &utf8String) {
@@ -455,92 +551,148 @@ ZLUnicodeUtil::Breakable ZLUnicodeUtil::isBreakable(Ucs4Char c) {
 	return BREAKABLE_AFTER;
 }
 
-/*
+bool ZLUnicodeUtil::ourUseJavaCaseMapping = false;
+
+void ZLUnicodeUtil::setJavaCaseMapping(bool useJava) {
+	ourUseJavaCaseMapping = useJava;
+}
+
+static const ZLUnicodeUtil::Ucs4Char CaseBlockMask = (1 << CaseTableShift) - 1;
+
 ZLUnicodeUtil::Ucs4Char ZLUnicodeUtil::toLower(Ucs4Char ch) {
-	initUnicodeTable();
-	std::map<ZLUnicodeUtil::Ucs4Char,ZLUnicodeData>::const_iterator it = UNICODE_TABLE.find(ch);
-	return (it != UNICODE_TABLE.end()) ? it->second.LowerCase : ch;
+	const std::size_t block = ch >> CaseTableShift;
+	if (block >= LowerCaseIndexSize) {
+		return ch;
+	}
+	const uint16_t delta = LowerCaseBlocks[LowerCaseIndex[block]][ch & CaseBlockMask];
+	return (ch & ~0xFFFF) | ((ch + delta) & 0xFFFF);
+}
+
+ZLUnicodeUtil::Ucs4Char ZLUnicodeUtil::toUpper(Ucs4Char ch) {
+	const std::size_t block = ch >> CaseTableShift;
+	if (block >= UpperCaseIndexSize) {
+		return ch;
+	}
+	const uint16_t delta = UpperCaseBlocks[UpperCaseIndex[block]][ch & CaseBlockMask];
+	return (ch & ~0xFFFF) | ((ch + delta) & 0xFFFF);
+}
+
+static std::size_t decodeUtf8Char(ZLUnicodeUtil::Ucs4Char &ch, const unsigned char *ptr, const unsigned char *end) {
+	std::size_t len;
+	if ((*ptr & 0xE0) == 0xC0) {
+		ch = *ptr & 0x1F;
+		len = 2;
+	} else if ((*ptr & 0xF0) == 0xE0) {
+		ch = *ptr & 0x0F;
+		len = 3;
+	} else if ((*ptr & 0xF8) == 0xF0) {
+		ch = *ptr & 0x07;
+		len = 4;
+	} else {
+		return 0;
+	}
+	if ((std::size_t)(end - ptr) < len) {
+		return 0;
+	}
+	for (std::size_t i = 1; i < len; ++i) {
+		if ((ptr[i] & 0xC0) != 0x80) {
+			return 0;
+		}
+		ch = (ch << 6) | (ptr[i] & 0x3F);
+	}
+	return len;
 }
 
-void ZLUnicodeUtil::toLower(Ucs4String &str) {
-	for (Ucs4String::iterator it = str.begin(); it != str.end(); ++it) {
-		*it = toLower(*it);
+static void appendUtf8Char(std::string &to, ZLUnicodeUtil::Ucs4Char ch) {
+	char buffer[4];
+	if (ch < 0x10000) {
+		to.append(buffer, ZLUnicodeUtil::ucs4ToUtf8(buffer, ch));
+	} else {
+		buffer[0] = (char)(0xF0 | (ch >> 18));
+		buffer[1] = (char)(0x80 | ((ch >> 12) & 0x3F));
+		buffer[2] = (char)(0x80 | ((ch >> 6) & 0x3F));
+		buffer[3] = (char)(0x80 | (ch & 0x3F));
+		to.append(buffer, 4);
 	}
 }
-*/
 
-std::string ZLUnicodeUtil::toLower(const std::string &utf8String) {
-	/*
-	Ucs4String ucs4String;
-	utf8ToUcs4(ucs4String, utf8String);
+// asciiFirst is 'A' for lower-casing and 'a' for upper-casing;
+// ASCII letters are mapped without table lookups
+static std::string mapCase(const std::string &utf8String, unsigned char asciiFirst, ZLUnicodeUtil::Ucs4Char (*mapper)(ZLUnicodeUtil::Ucs4Char)) {
+	const unsigned char *ptr = (const unsigned char*)utf8String.data();
+	const unsigned char *end = ptr + utf8String.length();
 
-	toLower(ucs4String);
+	for (; ptr < end; ++ptr) {
+		if (*ptr >= 0x80 || (unsigned char)(*ptr - asciiFirst) < 26) {
+			break;
+		}
+	}
+	if (ptr == end) {
+		return utf8String;
+	}
 
 	std::string result;
-	ucs4ToUtf8(result, ucs4String, utf8String.length());
-	return result;
-	*/
-	if (utf8String.empty()) {
-		return utf8String;
+	result.reserve(utf8String.length() + 4);
+	result.append(utf8String.data(), (const char*)ptr - utf8String.data());
+	while (ptr < end) {
+		if (*ptr < 0x80) {
+			result += (unsigned char)(*ptr - asciiFirst) < 26 ? (char)(*ptr ^ 0x20) : (char)*ptr;
+			++ptr;
+			continue;
+		}
+		ZLUnicodeUtil::Ucs4Char ch;
+		const std::size_t len = decodeUtf8Char(ch, ptr, end);
+		if (len == 0) {
+			// invalid sequence: copy the byte as is
+			result += (char)*ptr;
+			++ptr;
+			continue;
+		}
+		const ZLUnicodeUtil::Ucs4Char mapped = mapper(ch);
+		if (mapped == ch) {
+			result.append((const char*)ptr, len);
+		} else {
+			appendUtf8Char(result, mapped);
+		}
+		ptr += len;
 	}
+	return result;
+}
 
+static std::string javaCaseMapping(const std::string &utf8String, StringMethod &method) {
 	JNIEnv *env = AndroidUtil::getEnv();
 	jstring javaString = AndroidUtil::createJavaString(env, utf8String);
-	jstring lowerCased = AndroidUtil::Method_java_lang_String_toLowerCase->callForJavaString(javaString);
-	if (javaString == lowerCased) {
-		env->DeleteLocalRef(lowerCased);
+	jstring mapped = method.callForJavaString(javaString);
+	if (javaString == mapped) {
+		env->DeleteLocalRef(mapped);
 		env->DeleteLocalRef(javaString);
 		return utf8String;
 	} else {
-		const std::string result = AndroidUtil::fromJavaString(env, lowerCased);
-		env->DeleteLocalRef(lowerCased);
+		const std::string result = AndroidUtil::fromJavaString(env, mapped);
+		env->DeleteLocalRef(mapped);
 		env->DeleteLocalRef(javaString);
 		return result;
 	}
 }
 
-/*
-ZLUnicodeUtil::Ucs4Char ZLUnicodeUtil::toUpper(Ucs4Char ch) {
-	initUnicodeTable();
-	std::map<ZLUnicodeUtil::Ucs4Char,ZLUnicodeData>::const_iterator it = UNICODE_TABLE.find(ch);
-	return (it != UNICODE_TABLE.end()) ? it->second.UpperCase : ch;
-}
-
-void ZLUnicodeUtil::toUpper(Ucs4String &str) {
-	for (Ucs4String::iterator it = str.begin(); it != str.end(); ++it) {
-		*it = toUpper(*it);
+std::string ZLUnicodeUtil::toLower(const std::string &utf8String) {
+	if (utf8String.empty()) {
+		return utf8String;
+	}
+	if (ourUseJavaCaseMapping) {
+		return javaCaseMapping(utf8String, *AndroidUtil::Method_java_lang_String_toLowerCase);
 	}
+	return mapCase(utf8String, 'A', toLower);
 }
-*/
 
 std::string ZLUnicodeUtil::toUpper(const std::string &utf8String) {
-	/*
-	Ucs4String ucs4String;
-	utf8ToUcs4(ucs4String, utf8String);
-
-	toUpper(ucs4String);
-
-	std::string result;
-	ucs4ToUtf8(result, ucs4String, utf8String.length());
-	return result;
-	*/
 	if (utf8String.empty()) {
 		return utf8String;
 	}
-
-	JNIEnv *env = AndroidUtil::getEnv();
-	jstring javaString = AndroidUtil::createJavaString(env, utf8String);
-	jstring upperCased = AndroidUtil::Method_java_lang_String_toUpperCase->callForJavaString(javaString);
-	if (javaString == upperCased) {
-		env->DeleteLocalRef(upperCased);
-		env->DeleteLocalRef(javaString);
-		return utf8String;
-	} else {
-		const std::string result = AndroidUtil::fromJavaString(env, upperCased);
-		env->DeleteLocalRef(upperCased);
-		env->DeleteLocalRef(javaString);
-		return result;
+	if (ourUseJavaCaseMapping) {
+		return javaCaseMapping(utf8String, *AndroidUtil::Method_java_lang_String_toUpperCase);
 	}
+	return mapCase(utf8String, 'a', toUpper);
 }
 
 void ZLUnicodeUtil::utf8Trim(std::string &utf8String) {
@@ -41,6 +41,8 @@ public:
 		BREAKABLE_AFTER
 	};
 	
+	// the number of leading bytes below 0x80
+	static std::size_t asciiLength(const char *str, std::size_t len);
 	static bool isUtf8String(const char *str, int len);
 	static bool isUtf8String(const std::string &str);
 	static void cleanUtf8String(std::string &str);
@@ -52,6 +54,9 @@ public:
 	static void utf8ToUcs4(Ucs4String &to, const std::string &from, int toLength = -1);
 	static void utf8ToUcs2(Ucs2String &to, const char *from, int length, int toLength = -1);
 	static void utf8ToUcs2(Ucs2String &to, const std::string &from, int toLength = -1);
+	// writes utf8Length(from, length) characters, that is at most length,
+	// and returns their number
+	static std::size_t utf8ToUcs2(Ucs2Char *to, const char *from, std::size_t length);
 	static std::size_t firstChar(Ucs4Char &ch, const char *utf8String);
 	static std::size_t firstChar(Ucs4Char &ch, const std::string &utf8String);
 	static std::size_t lastChar(Ucs4Char &ch, const char *utf8String);
@@ -65,15 +70,23 @@ public:
 	static bool isNBSpace(Ucs4Char ch);
 	static Breakable isBreakable(Ucs4Char ch);
 
-	//static Ucs4Char toLower(Ucs4Char ch);
+	// simple (one-to-one) case mapping, see ZLUnicodeCaseTables.h
+	static Ucs4Char toLower(Ucs4Char ch);
 	//static void toLower(Ucs4String &str);
 	static std::string toLower(const std::string &utf8String);
 
-	//static Ucs4Char toUpper(Ucs4Char ch);
+	static Ucs4Char toUpper(Ucs4Char ch);
 	//static void toUpper(Ucs4String &str);
 	static std::string toUpper(const std::string &utf8String);
 
+	// when set, string case mapping goes through java.lang.String;
+	// used to compare native tables against Java results
+	static void setJavaCaseMapping(bool useJava);
+
 	static void utf8Trim(std::string &utf8String);
+
+private:
+	static bool ourUseJavaCaseMapping;
 };
 
 inline bool ZLUnicodeUtil::isNBSpace(Ucs4Char ch) {
@@ -17,6 +17,9 @@
  * 02110-1301, USA.
  */
 
+#include <pthread.h>
+
+#include <cctype>
 #include <cstring>
 
 #include <algorithm>
@@ -60,7 +63,22 @@ bool ZLXMLReaderHandler::handleBuffer(const char *data, std::size_t len) {
 	return myReader.readFromBuffer(data, len);
 }
 
-static const std::size_t BUFFER_SIZE = 2048;
+static const std::size_t BUFFER_SIZE = 16384;
+
+// pattern must be in lower case
+static bool containsIgnoringCase(const char *start, const char *end, const char *pattern) {
+	const std::size_t length = std::strlen(pattern);
+	for (; start + length <= end; ++start) {
+		std::size_t i = 0;
+		while (i < length && std::tolower((unsigned char)start[i]) == pattern[i]) {
+			++i;
+		}
+		if (i == length) {
+			return true;
+		}
+	}
+	return false;
+}
 
 void ZLXMLReader::startElementHandler(const char*, const char**) {
 }
@@ -72,7 +90,30 @@ void ZLXMLReader::characterDataHandler(const char*, std::size_t) {
 }
 
 const ZLXMLReader::nsMap &ZLXMLReader::namespaces() const {
-	return *myNamespaces.back();
+	return *myNamespaceScopes.back().Namespaces;
+}
+
+int ZLXMLReader::namespaceId(const std::string &uri) {
+	static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+	static std::map<std::string,int> ids;
+	pthread_mutex_lock(&mutex);
+	std::map<std::string,int>::const_iterator it = ids.find(uri);
+	if (it == ids.end()) {
+		it = ids.insert(std::make_pair(uri, (int)ids.size() + 1)).first;
+	}
+	const int id = it->second;
+	pthread_mutex_unlock(&mutex);
+	return id;
+}
+
+const ZLXMLReader::NamespaceBinding *ZLXMLReader::binding(const char *prefix, std::size_t length) const {
+	const std::vector<NamespaceBinding> &bindings = myNamespaceScopes.back().Bindings;
+	for (std::vector<NamespaceBinding>::const_iterator it = bindings.begin(); it != bindings.end(); ++it) {
+		if (it->Prefix.length() == length && std::strncmp(it->Prefix.data(), prefix, length) == 0) {
+			return &*it;
+		}
+	}
+	return 0;
 }
 
 ZLXMLReader::ZLXMLReader(const char *encoding) {
@@ -94,31 +135,41 @@ bool ZLXMLReader::readDocument(shared_ptr<ZLInputStream> stream) {
 		return false;
 	}
 
+	// the encoding is sniffed from the first chunk, which is then parsed
+	// as is: seeking back would restart decompression of a zipped file
+	std::size_t length;
+	const char *data = stream->borrow(length);
+	const bool borrowed = data != 0;
+	if (!borrowed) {
+		length = stream->read(myParserBuffer, BUFFER_SIZE);
+		data = myParserBuffer;
+	}
+
 	bool useWindows1252 = false;
-	stream->read(myParserBuffer, 256);
-	std::string stringBuffer(myParserBuffer, 256);
-	stream->seek(0, true);
-	int index = stringBuffer.find('>');
-	if (index > 0) {
-		stringBuffer = stringBuffer.substr(0, index);
-		if (!ZLUnicodeUtil::isUtf8String(stringBuffer)) {
+	const char *declarationEnd = (const char*)std::memchr(data, '>', std::min(length, (std::size_t)256));
+	if (declarationEnd != 0 && declarationEnd != data) {
+		if (!ZLUnicodeUtil::isUtf8String(data, declarationEnd - data)) {
 			return false;
 		}
-		stringBuffer = ZLUnicodeUtil::toLower(stringBuffer);
-		int index = stringBuffer.find("\"iso-8859-1\"");
-		if (index > 0) {
-			useWindows1252 = true;
-		}
+		useWindows1252 = containsIgnoringCase(data, declarationEnd, "\"iso-8859-1\"");
 	}
 	initialize(useWindows1252 ? "windows-1252" : 0);
 
-	std::size_t length;
-	do {
-		length = stream->read(myParserBuffer, BUFFER_SIZE);
-		if (!readFromBuffer(myParserBuffer, length)) {
-			break;
+	if (borrowed) {
+		// the data is parsed in place, in chunks to check for interruption
+		while (length > 0 && !myInterrupted) {
+			const std::size_t chunk = std::min(length, BUFFER_SIZE);
+			if (!readFromBuffer(data, chunk)) {
+				break;
+			}
+			data += chunk;
+			length -= chunk;
+		}
+	} else {
+		while (readFromBuffer(myParserBuffer, length) && length == BUFFER_SIZE && !myInterrupted) {
+			length = stream->read(myParserBuffer, BUFFER_SIZE);
 		}
-	} while ((length == BUFFER_SIZE) && !myInterrupted);
+	}
 
 	stream->close();
 
@@ -130,11 +181,15 @@ bool ZLXMLReader::readDocument(shared_ptr<ZLInputStream> stream) {
 void ZLXMLReader::initialize(const char *encoding) {
 	myInternalReader->init(encoding);
 	myInterrupted = false;
-	myNamespaces.push_back(new nsMap());
+	myNamespaceScopes.clear();
+	myNamespaceScopes.push_back(NamespaceScope());
+	myNamespaceScopes.back().Depth = 0;
+	myNamespaceScopes.back().Namespaces = new nsMap();
+	myElementDepth = 0;
 }
 
 void ZLXMLReader::shutdown() {
-	myNamespaces.clear();
+	myNamespaceScopes.clear();
 }
 
 bool ZLXMLReader::readFromBuffer(const char *data, std::size_t len) {
@@ -182,35 +237,33 @@ bool ZLXMLReader::SimpleNamePredicate::accepts(const ZLXMLReader&, const std::st
 	return myName == name;
 }
 
-ZLXMLReader::FullNamePredicate::FullNamePredicate(const std::string &ns, const std::string &name) : myNamespaceName(ns), myName(name) {
+ZLXMLReader::FullNamePredicate::FullNamePredicate(const std::string &ns, const std::string &name) : myNamespaceId(namespaceId(ns)), myName(name) {
 }
 
 bool ZLXMLReader::FullNamePredicate::accepts(const ZLXMLReader &reader, const char *name) const {
-	return accepts(reader, std::string(name));
+	const char *colon = std::strchr(name, ':');
+	const char *localName = colon != 0 ? colon + 1 : name;
+	if (myName != localName) {
+		return false;
+	}
+	const NamespaceBinding *binding = reader.binding(name, colon != 0 ? colon - name : 0);
+	return binding != 0 && binding->Id == myNamespaceId;
 }
 
 bool ZLXMLReader::FullNamePredicate::accepts(const ZLXMLReader &reader, const std::string &name) const {
-	const std::size_t index = name.find(':');
-	const std::string namespaceId =
-		index == std::string::npos ? std::string() : name.substr(0, index);
-
-	const nsMap &namespaces = reader.namespaces();
-	nsMap::const_iterator it = namespaces.find(namespaceId);
-	return
-		it != namespaces.end() &&
-		it->second == myNamespaceName &&
-		name.substr(index + 1) == myName;
+	return accepts(reader, name.c_str());
 }
 
 ZLXMLReader::BrokenNamePredicate::BrokenNamePredicate(const std::string &name) : myName(name) {
 }
 
-bool ZLXMLReader::BrokenNamePredicate::accepts(const ZLXMLReader &reader, const char *name) const {
-	return accepts(reader, std::string(name));
+bool ZLXMLReader::BrokenNamePredicate::accepts(const ZLXMLReader&, const char *name) const {
+	const char *colon = std::strchr(name, ':');
+	return myName == (colon != 0 ? colon + 1 : name);
 }
 
 bool ZLXMLReader::BrokenNamePredicate::accepts(const ZLXMLReader &reader, const std::string &name) const {
-	return myName == name.substr(name.find(':') + 1);
+	return accepts(reader, name.c_str());
 }
 
 const char *ZLXMLReader::attributeValue(const char **xmlattributes, const NamePredicate &predicate) const {
@@ -229,11 +282,9 @@ const char *ZLXMLReader::attributeValue(const char **xmlattributes, const NamePr
 }
 
 bool ZLXMLReader::testTag(const std::string &ns, const std::string &name, const std::string &tag) const {
-	const nsMap &nspaces = namespaces();
-
 	if (name == tag) {
-		const nsMap::const_iterator it = nspaces.find(std::string());
-		return it != nspaces.end() && ns == it->second;
+		const NamespaceBinding *binding = this->binding("", 0);
+		return binding != 0 && ns == binding->Uri;
 	}
 	const int nameLen = name.size();
 	const int tagLen = tag.size();
@@ -241,8 +292,8 @@ bool ZLXMLReader::testTag(const std::string &ns, const std::string &name, const
 		return false;
 	}
 	if (ZLStringUtil::stringEndsWith(tag, name) && tag[tagLen - nameLen - 1] == ':') {
-		const nsMap::const_iterator it = nspaces.find(tag.substr(0, tagLen - nameLen - 1));
-		return it != nspaces.end() && ns == it->second;
+		const NamespaceBinding *binding = this->binding(tag.data(), tagLen - nameLen - 1);
+		return binding != 0 && ns == binding->Uri;
 	}
 	return false;
 }
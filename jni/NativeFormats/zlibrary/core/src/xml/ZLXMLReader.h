@@ -61,7 +61,7 @@ public:
 		bool accepts(const ZLXMLReader &reader, const std::string &name) const;
 
 	private:
-		const std::string myNamespaceName;
+		const int myNamespaceId;
 		const std::string myName;
 	};
 
@@ -91,6 +91,9 @@ public:
 	typedef std::map<std::string,std::string> nsMap;
 	const nsMap &namespaces() const;
 
+	// equal namespace URIs get equal ids; 0 is never used as an id
+	static int namespaceId(const std::string &uri);
+
 	const char *attributeValue(const char **xmlattributes, const char *name) const;
 	const char *attributeValue(const char **xmlattributes, const NamePredicate &predicate) const;
 
@@ -115,11 +118,29 @@ protected:
 	void interrupt();
 	void setErrorMessage(const std::string &message);
 
+private:
+	struct NamespaceBinding {
+		std::string Prefix;
+		std::string Uri;
+		int Id;
+	};
+
+	// namespaces declared by an element and its ancestors;
+	// a new scope is created only by elements with xmlns attributes
+	struct NamespaceScope {
+		int Depth;
+		shared_ptr<nsMap> Namespaces;
+		std::vector<NamespaceBinding> Bindings;
+	};
+
+	const NamespaceBinding *binding(const char *prefix, std::size_t length) const;
+
 private:
 	bool myInterrupted;
 	ZLXMLReaderInternal *myInternalReader;
 	char *myParserBuffer;
-	std::vector<shared_ptr<nsMap> > myNamespaces;
+	std::vector<NamespaceScope> myNamespaceScopes;
+	int myElementDepth;
 
 	std::string myErrorMessage;
 
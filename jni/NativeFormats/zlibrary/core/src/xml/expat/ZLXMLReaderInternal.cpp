@@ -17,11 +17,17 @@
  * 02110-1301, USA.
  */
 
+#include <pthread.h>
+
 #include <cstring>
 
+#include <map>
+
 #include <ZLFile.h>
 #include <ZLInputStream.h>
 #include <ZLEncodingConverter.h>
+#include <ZLStringUtil.h>
+#include <ZLUnicodeUtil.h>
 
 #include "ZLXMLReaderInternal.h"
 #include "../ZLXMLReader.h"
@@ -37,7 +43,7 @@ void ZLXMLReaderInternal::fStartElementHandler(void *userData, const char *name,
 	ZLXMLReader &reader = *(ZLXMLReader*)userData;
 	if (!reader.isInterrupted()) {
 		if (reader.processNamespaces()) {
-			int count = 0;
+			++reader.myElementDepth;
 			for (const char **a = attributes; (*a != 0) && (*(a + 1) != 0); a += 2) {
 				if (std::strncmp(*a, "xmlns", 5) == 0) {
 					std::string id;
@@ -46,19 +52,28 @@ void ZLXMLReaderInternal::fStartElementHandler(void *userData, const char *name,
 					} else if ((*a)[5] != '\0') {
 						continue;
 					}
-					if (count == 0) {
-						reader.myNamespaces.push_back(
-							new std::map<std::string,std::string>(*reader.myNamespaces.back())
-						);
+					if (reader.myNamespaceScopes.back().Depth != reader.myElementDepth) {
+						// copies the parent scope
+						reader.myNamespaceScopes.push_back(reader.myNamespaceScopes.back());
+						ZLXMLReader::NamespaceScope &scope = reader.myNamespaceScopes.back();
+						scope.Depth = reader.myElementDepth;
+						scope.Namespaces = new ZLXMLReader::nsMap(*scope.Namespaces);
 					}
-					++count;
+					ZLXMLReader::NamespaceScope &scope = reader.myNamespaceScopes.back();
 					const std::string reference(*(a + 1));
-					(*reader.myNamespaces.back())[id] = reference;
+					(*scope.Namespaces)[id] = reference;
+					std::vector<ZLXMLReader::NamespaceBinding>::iterator it = scope.Bindings.begin();
+					for (; it != scope.Bindings.end() && it->Prefix != id; ++it) {
+					}
+					if (it == scope.Bindings.end()) {
+						scope.Bindings.push_back(ZLXMLReader::NamespaceBinding());
+						it = scope.Bindings.end() - 1;
+						it->Prefix = id;
+					}
+					it->Uri = reference;
+					it->Id = ZLXMLReader::namespaceId(reference);
 				}
 			}
-			if (count == 0) {
-				reader.myNamespaces.push_back(reader.myNamespaces.back());
-			}
 		}
 		reader.startElementHandler(name, attributes);
 	}
@@ -69,8 +84,10 @@ void ZLXMLReaderInternal::fEndElementHandler(void *userData, const char *name) {
 	if (!reader.isInterrupted()) {
 		reader.endElementHandler(name);
 		if (reader.processNamespaces()) {
-			shared_ptr<std::map<std::string,std::string> > oldMap = reader.myNamespaces.back();
-			reader.myNamespaces.pop_back();
+			if (reader.myNamespaceScopes.back().Depth == reader.myElementDepth) {
+				reader.myNamespaceScopes.pop_back();
+			}
+			--reader.myElementDepth;
 		}
 	}
 }
@@ -102,16 +119,66 @@ static void parseDTD(XML_Parser parser, const std::string &fileName) {
 	XML_ParserFree(entityParser);
 }
 
-static void parseExtraDTDEntities(XML_Parser parser, const std::map<std::string, std::string> &entityMap) {
+// writes the declaration in ASCII, with the replacement text escaped,
+// so that parsing it gives exactly the same entity
+static void fEntityDeclHandler(void *userData, const XML_Char *name, int isParameterEntity, const XML_Char *value, int length, const XML_Char*, const XML_Char*, const XML_Char*, const XML_Char*) {
+	if (isParameterEntity || value == 0) {
+		return;
+	}
+	std::string &declarations = *(std::string*)userData;
+	declarations.append("<!ENTITY ").append(name).append(" \"");
+	const std::string text(value, length);
+	for (std::size_t i = 0; i < text.length();) {
+		const unsigned char ch = text[i];
+		if (ch >= 0x20 && ch < 0x80 && ch != '&' && ch != '%' && ch != '"') {
+			declarations += ch;
+			++i;
+		} else {
+			ZLUnicodeUtil::Ucs4Char ucs4;
+			i += ZLUnicodeUtil::firstChar(ucs4, text.data() + i);
+			declarations.append("&#");
+			ZLStringUtil::appendNumber(declarations, ucs4);
+			declarations += ';';
+		}
+	}
+	declarations.append("\">");
+}
+
+// DTD files are parsed once per process; documents are seeded
+// with the collected declarations instead
+static pthread_mutex_t ourDeclarationsMutex = PTHREAD_MUTEX_INITIALIZER;
+static std::map<std::vector<std::string>,std::string> ourDeclarations;
+
+static const std::string &entityDeclarations(const std::vector<std::string> &dtds) {
+	pthread_mutex_lock(&ourDeclarationsMutex);
+	std::map<std::vector<std::string>,std::string>::iterator it = ourDeclarations.find(dtds);
+	if (it == ourDeclarations.end()) {
+		it = ourDeclarations.insert(std::make_pair(dtds, std::string())).first;
+		XML_Parser parser = XML_ParserCreate(0);
+		XML_SetUserData(parser, &it->second);
+		XML_SetEntityDeclHandler(parser, fEntityDeclHandler);
+		for (std::vector<std::string>::const_iterator jt = dtds.begin(); jt != dtds.end(); ++jt) {
+			parseDTD(parser, *jt);
+		}
+		XML_ParserFree(parser);
+	}
+	// map elements are never changed or removed after creation
+	const std::string &declarations = it->second;
+	pthread_mutex_unlock(&ourDeclarationsMutex);
+	return declarations;
+}
+
+static void parseDTDEntities(XML_Parser parser, const std::string &declarations, const std::map<std::string, std::string> &entityMap) {
 	XML_Parser entityParser = XML_ExternalEntityParserCreate(parser, 0, 0);
-	std::string buffer;
-
-	std::map<std::string, std::string>::const_iterator it = entityMap.begin();
-	for (; it != entityMap.end(); ++it) {
-		buffer.clear();
-		buffer.append("<!ENTITY ").append(it->first).append(" \"").append(it->second).append("\">");
-		if (XML_Parse(entityParser, buffer.data(), buffer.size(), 0) == XML_STATUS_ERROR) {
-			break;
+	if (XML_Parse(entityParser, declarations.data(), declarations.size(), 0) != XML_STATUS_ERROR) {
+		std::string buffer;
+		std::map<std::string, std::string>::const_iterator it = entityMap.begin();
+		for (; it != entityMap.end(); ++it) {
+			buffer.clear();
+			buffer.append("<!ENTITY ").append(it->first).append(" \"").append(it->second).append("\">");
+			if (XML_Parse(entityParser, buffer.data(), buffer.size(), 0) == XML_STATUS_ERROR) {
+				break;
+			}
 		}
 	}
 	XML_ParserFree(entityParser);
@@ -128,15 +195,13 @@ ZLXMLReaderInternal::~ZLXMLReaderInternal() {
 
 void ZLXMLReaderInternal::setupEntities() {
 	const std::vector<std::string> &dtds = myReader.externalDTDs();
-	for (std::vector<std::string>::const_iterator it = dtds.begin(); it != dtds.end(); ++it) {
-		myDTDStreamLocks.insert(ZLFile(*it).inputStream());
-		parseDTD(myParser, *it);
-	}
+	static const std::string NO_DECLARATIONS;
+	const std::string &declarations = dtds.empty() ? NO_DECLARATIONS : entityDeclarations(dtds);
 
 	std::map<std::string,std::string> entityMap;
 	myReader.collectExternalEntities(entityMap);
-	if (!entityMap.empty()) {
-		parseExtraDTDEntities(myParser, entityMap);
+	if (!declarations.empty() || !entityMap.empty()) {
+		parseDTDEntities(myParser, declarations, entityMap);
 	}
 }
 
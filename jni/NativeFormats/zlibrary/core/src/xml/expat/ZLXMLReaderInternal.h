@@ -22,8 +22,6 @@
 
 #include <expat.h>
 
-#include <set>
-
 class ZLXMLReader;
 
 class ZLXMLReaderInternal {
@@ -47,8 +45,6 @@ private:
 	ZLXMLReader &myReader;
 	XML_Parser myParser;
 	bool myInitialized;
-
-	std::set<shared_ptr<ZLInputStream> > myDTDStreamLocks;
 };
 
 #endif /* __ZLXMLREADERINTERNAL_H__ */
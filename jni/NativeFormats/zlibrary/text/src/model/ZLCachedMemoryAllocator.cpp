@@ -38,26 +38,44 @@ ZLCachedMemoryAllocator::ZLCachedMemoryAllocator(const std::size_t rowSize,
 	myHasChanges(false),
 	myFailed(false),
 	myDirectoryName(directoryName),
-	myFileExtension(fileExtension) {
+	myFileExtension(fileExtension),
+	myWriterIsStarted(false),
+	myWriterIsStopping(false),
+	myWriteFailed(false) {
 	ZLFile(directoryName).directory(true);
+	pthread_mutex_init(&myWriterMutex, 0);
+	pthread_cond_init(&myRequestAdded, 0);
+	pthread_cond_init(&myRequestDone, 0);
 }
 
 ZLCachedMemoryAllocator::~ZLCachedMemoryAllocator() {
 	flush();
+	stopWriter();
+	pthread_cond_destroy(&myRequestDone);
+	pthread_cond_destroy(&myRequestAdded);
+	pthread_mutex_destroy(&myWriterMutex);
 	for (std::vector<char*>::const_iterator it = myPool.begin(); it != myPool.end(); ++it) {
 		delete[] *it;
 	}
 }
 
 void ZLCachedMemoryAllocator::flush() {
-	if (!myHasChanges) {
-		return;
+	if (myHasChanges) {
+		char *ptr = myPool.back() + myOffset;
+		*ptr++ = 0;
+		*ptr = 0;
+		writeCache(myOffset + 2);
+		myHasChanges = false;
 	}
-	char *ptr = myPool.back() + myOffset;
-	*ptr++ = 0;
-	*ptr = 0;
-	writeCache(myOffset + 2);
-	myHasChanges = false;
+
+	pthread_mutex_lock(&myWriterMutex);
+	while (!myWriteQueue.empty()) {
+		pthread_cond_wait(&myRequestDone, &myWriterMutex);
+	}
+	if (myWriteFailed) {
+		myFailed = true;
+	}
+	pthread_mutex_unlock(&myWriterMutex);
 }
 
 std::string ZLCachedMemoryAllocator::makeFileName(std::size_t index) {
@@ -67,20 +85,83 @@ std::string ZLCachedMemoryAllocator::makeFileName(std::size_t index) {
 	return name.append(".").append(myFileExtension);
 }
 
+// at most this number of rows is waiting to be written
+static const std::size_t MAX_QUEUED_ROWS = 4;
+
 void ZLCachedMemoryAllocator::writeCache(std::size_t blockLength) {
 	if (myFailed || myPool.size() == 0) {
 		return;
 	}
 	const std::size_t index = myPool.size() - 1;
-	const std::string fileName = makeFileName(index);
-	ZLFile file(fileName);
-	shared_ptr<ZLOutputStream> stream = file.outputStream();
-	if (stream.isNull() || !stream->open()) {
+	const WriteRequest request(ZLFile(makeFileName(index)), myPool[index], blockLength);
+
+	pthread_mutex_lock(&myWriterMutex);
+	if (!myWriterIsStarted) {
+		myWriterIsStarted = pthread_create(&myWriter, 0, writerThread, this) == 0;
+	}
+	if (myWriterIsStarted) {
+		while (myWriteQueue.size() >= MAX_QUEUED_ROWS) {
+			pthread_cond_wait(&myRequestDone, &myWriterMutex);
+		}
+		myWriteQueue.push_back(request);
+		pthread_cond_signal(&myRequestAdded);
+	} else if (!myWriteFailed && !writeRow(request)) {
+		myWriteFailed = true;
+	}
+	if (myWriteFailed) {
 		myFailed = true;
-		return;
 	}
-	stream->write(myPool[index], blockLength);
+	pthread_mutex_unlock(&myWriterMutex);
+}
+
+bool ZLCachedMemoryAllocator::writeRow(const WriteRequest &request) {
+	shared_ptr<ZLOutputStream> stream = request.File.outputStream();
+	if (stream.isNull() || !stream->open()) {
+		return false;
+	}
+	stream->write(request.Data, request.Length);
 	stream->close();
+	return true;
+}
+
+void *ZLCachedMemoryAllocator::writerThread(void *data) {
+	((ZLCachedMemoryAllocator*)data)->writeRows();
+	return 0;
+}
+
+void ZLCachedMemoryAllocator::writeRows() {
+	pthread_mutex_lock(&myWriterMutex);
+	while (true) {
+		while (myWriteQueue.empty() && !myWriterIsStopping) {
+			pthread_cond_wait(&myRequestAdded, &myWriterMutex);
+		}
+		if (myWriteQueue.empty()) {
+			break;
+		}
+		const WriteRequest request = myWriteQueue.front();
+		const bool skip = myWriteFailed;
+		pthread_mutex_unlock(&myWriterMutex);
+		const bool success = skip || writeRow(request);
+		pthread_mutex_lock(&myWriterMutex);
+		if (!success) {
+			myWriteFailed = true;
+		}
+		myWriteQueue.pop_front();
+		pthread_cond_broadcast(&myRequestDone);
+	}
+	pthread_mutex_unlock(&myWriterMutex);
+}
+
+void ZLCachedMemoryAllocator::stopWriter() {
+	if (!myWriterIsStarted) {
+		return;
+	}
+	pthread_mutex_lock(&myWriterMutex);
+	myWriterIsStopping = true;
+	pthread_cond_signal(&myRequestAdded);
+	pthread_mutex_unlock(&myWriterMutex);
+	pthread_join(myWriter, 0);
+	myWriterIsStarted = false;
 }
 
 char *ZLCachedMemoryAllocator::allocate(std::size_t size) {
@@ -20,8 +20,12 @@
 #ifndef __ZLCACHEDMEMORYALLOCATOR_H__
 #define __ZLCACHEDMEMORYALLOCATOR_H__
 
+#include <pthread.h>
+
 #include <vector>
+#include <deque>
 
+#include <ZLFile.h>
 #include <ZLUnicodeUtil.h>
 
 class ZLCachedMemoryAllocator {
@@ -33,6 +37,7 @@ public:
 	char *allocate(std::size_t size);
 	char *reallocateLast(char *ptr, std::size_t newSize);
 
+	// writes the current row and waits for all the rows to be written
 	void flush();
 
 	static char *writeUInt16(char *ptr, uint16_t value);
@@ -46,12 +51,26 @@ public:
 	const std::string &fileExtension() const;
 	std::size_t blocksNumber() const;
 	std::size_t currentBytesOffset() const;
+	// includes write errors found by flush()
 	bool failed() const;
 
 private:
+	struct WriteRequest {
+		WriteRequest(const ZLFile &file, const char *data, std::size_t length);
+
+		const ZLFile File;
+		const char *Data;
+		const std::size_t Length;
+	};
+
 	std::string makeFileName(std::size_t index);
 	void writeCache(std::size_t blockLength);
 
+	static bool writeRow(const WriteRequest &request);
+	static void *writerThread(void *data);
+	void writeRows();
+	void stopWriter();
+
 private:
 	const std::size_t myRowSize;
 	std::size_t myCurrentRowSize;
@@ -64,11 +83,25 @@ private:
 	const std::string myDirectoryName;
 	const std::string myFileExtension;
 
+	// completed rows are written by a separate thread;
+	// the rows stay in the pool, so requests only point to them
+	pthread_t myWriter;
+	bool myWriterIsStarted;
+	pthread_mutex_t myWriterMutex;
+	pthread_cond_t myRequestAdded;
+	pthread_cond_t myRequestDone;
+	// the front request is removed after it is written
+	std::deque<WriteRequest> myWriteQueue;
+	bool myWriterIsStopping;
+	bool myWriteFailed;
+
 private: // disable copying
 	ZLCachedMemoryAllocator(const ZLCachedMemoryAllocator&);
 	const ZLCachedMemoryAllocator &operator = (const ZLCachedMemoryAllocator&);
 };
 
+inline ZLCachedMemoryAllocator::WriteRequest::WriteRequest(const ZLFile &file, const char *data, std::size_t length) : File(file), Data(data), Length(length) {}
+
 inline const std::string &ZLCachedMemoryAllocator::directoryName() const { return myDirectoryName; }
 inline const std::string &ZLCachedMemoryAllocator::fileExtension() const { return myFileExtension; }
 inline std::size_t ZLCachedMemoryAllocator::blocksNumber() const { return myPool.size(); }
@@ -48,9 +48,6 @@ ZLTextModel::ZLTextModel(const std::string &id, const std::string &language, sha
 }
 
 ZLTextModel::~ZLTextModel() {
-	for (std::vector<ZLTextParagraph*>::const_iterator it = myParagraphs.begin(); it != myParagraphs.end(); ++it) {
-		delete *it;
-	}
 }
 
 /*
@@ -119,17 +116,68 @@ ZLTextMark ZLTextModel::previousMark(ZLTextMark position) const {
 }
 */
 
-void ZLTextModel::addParagraphInternal(ZLTextParagraph *paragraph) {
+static const std::size_t ARENA_INITIAL_CAPACITY = 64;
+// four int columns and the kinds
+static const std::size_t ARENA_BYTES_PER_PARAGRAPH = 4 * sizeof(jint) + sizeof(jbyte);
+
+ZLTextParagraphArena::ZLTextParagraphArena() :
+	myBlock(0),
+	mySize(0),
+	myCapacity(0),
+	myStartEntryIndices(0),
+	myStartEntryOffsets(0),
+	myParagraphLengths(0),
+	myTextSizes(0),
+	myParagraphKinds(0) {
+}
+
+ZLTextParagraphArena::~ZLTextParagraphArena() {
+	delete[] myBlock;
+}
+
+void ZLTextParagraphArena::add(jint startEntryIndex, jint startEntryOffset, jbyte kind) {
+	if (mySize == myCapacity) {
+		grow();
+	}
+	myStartEntryIndices[mySize] = startEntryIndex;
+	myStartEntryOffsets[mySize] = startEntryOffset;
+	myParagraphLengths[mySize] = 0;
+	myTextSizes[mySize] = mySize == 0 ? 0 : myTextSizes[mySize - 1];
+	myParagraphKinds[mySize] = kind;
+	++mySize;
+}
+
+void ZLTextParagraphArena::grow() {
+	const std::size_t capacity = std::max(ARENA_INITIAL_CAPACITY, 2 * myCapacity);
+	char *block = new char[capacity * ARENA_BYTES_PER_PARAGRAPH];
+	jint *startEntryIndices = (jint*)block;
+	jint *startEntryOffsets = startEntryIndices + capacity;
+	jint *paragraphLengths = startEntryOffsets + capacity;
+	jint *textSizes = paragraphLengths + capacity;
+	jbyte *paragraphKinds = (jbyte*)(textSizes + capacity);
+	if (mySize > 0) {
+		std::memcpy(startEntryIndices, myStartEntryIndices, mySize * sizeof(jint));
+		std::memcpy(startEntryOffsets, myStartEntryOffsets, mySize * sizeof(jint));
+		std::memcpy(paragraphLengths, myParagraphLengths, mySize * sizeof(jint));
+		std::memcpy(textSizes, myTextSizes, mySize * sizeof(jint));
+		std::memcpy(paragraphKinds, myParagraphKinds, mySize * sizeof(jbyte));
+	}
+	delete[] myBlock;
+	myBlock = block;
+	myCapacity = capacity;
+	myStartEntryIndices = startEntryIndices;
+	myStartEntryOffsets = startEntryOffsets;
+	myParagraphLengths = paragraphLengths;
+	myTextSizes = textSizes;
+	myParagraphKinds = paragraphKinds;
+}
+
+void ZLTextModel::addParagraphInternal(ZLTextParagraph::Kind kind) {
 	const std::size_t dataSize = myAllocator->blocksNumber();
 	const std::size_t bytesOffset = myAllocator->currentBytesOffset();
 
-	myStartEntryIndices.push_back((dataSize == 0) ? 0 : (dataSize - 1));
-	myStartEntryOffsets.push_back(bytesOffset / 2); // offset in words for future use in Java
-	myParagraphLengths.push_back(0);
-	myTextSizes.push_back(myTextSizes.empty() ? 0 : myTextSizes.back());
-	myParagraphKinds.push_back(paragraph->kind());
-
-	myParagraphs.push_back(paragraph);
+	// offset in words for future use in Java
+	myParagraphs.add((dataSize == 0) ? 0 : (dataSize - 1), bytesOffset / 2, kind);
 	myLastEntryStart = 0;
 }
 
@@ -143,73 +191,59 @@ ZLTextPlainModel::ZLTextPlainModel(const std::string &id, const std::string &lan
 }
 
 void ZLTextPlainModel::createParagraph(ZLTextParagraph::Kind kind) {
-	ZLTextParagraph *paragraph = (kind == ZLTextParagraph::TEXT_PARAGRAPH) ? new ZLTextParagraph() : new ZLTextSpecialParagraph(kind);
-	addParagraphInternal(paragraph);
+	addParagraphInternal(kind);
 }
 
 void ZLTextModel::addText(const std::string &text) {
-	ZLUnicodeUtil::Ucs2String ucs2str;
-	ZLUnicodeUtil::utf8ToUcs2(ucs2str, text);
-	const std::size_t len = ucs2str.size();
-
-	if (myLastEntryStart != 0 && *myLastEntryStart == ZLTextParagraphEntry::TEXT_ENTRY) {
-		const std::size_t oldLen = ZLCachedMemoryAllocator::readUInt32(myLastEntryStart + 2);
-		const std::size_t newLen = oldLen + len;
-		myLastEntryStart = myAllocator->reallocateLast(myLastEntryStart, 2 * newLen + 6);
-		ZLCachedMemoryAllocator::writeUInt32(myLastEntryStart + 2, newLen);
-		std::memcpy(myLastEntryStart + 6 + oldLen, &ucs2str.front(), 2 * newLen);
-	} else {
-		myLastEntryStart = myAllocator->allocate(2 * len + 6);
-		*myLastEntryStart = ZLTextParagraphEntry::TEXT_ENTRY;
-		*(myLastEntryStart + 1) = 0;
-		ZLCachedMemoryAllocator::writeUInt32(myLastEntryStart + 2, len);
-		std::memcpy(myLastEntryStart + 6, &ucs2str.front(), 2 * len);
-		myParagraphs.back()->addEntry(myLastEntryStart);
-		++myParagraphLengths.back();
-	}
-	myTextSizes.back() += len;
+	const char *data = text.data();
+	const std::size_t length = text.length();
+	addText(&data, &length, 1);
 }
 
 void ZLTextModel::addText(const std::vector<std::string> &text) {
 	if (text.size() == 0) {
 		return;
 	}
-	std::size_t fullLength = 0;
+	std::vector<const char*> &data = myTextData;
+	std::vector<std::size_t> &lengths = myTextLengths;
+	data.clear();
+	lengths.clear();
 	for (std::vector<std::string>::const_iterator it = text.begin(); it != text.end(); ++it) {
-		fullLength += ZLUnicodeUtil::utf8Length(*it);
+		data.push_back(it->data());
+		lengths.push_back(it->length());
+	}
+	addText(&data.front(), &lengths.front(), text.size());
+}
+
+void ZLTextModel::addText(const char *const *data, const std::size_t *lengths, std::size_t count) {
+	// UTF-8 never takes fewer bytes than UTF-16 code units,
+	// so the entry is allocated for the byte length and shrunk then
+	std::size_t maxLen = 0;
+	for (std::size_t i = 0; i < count; ++i) {
+		maxLen += lengths[i];
 	}
 
-	ZLUnicodeUtil::Ucs2String ucs2str;
+	std::size_t oldLen = 0;
 	if (myLastEntryStart != 0 && *myLastEntryStart == ZLTextParagraphEntry::TEXT_ENTRY) {
-		const std::size_t oldLen = ZLCachedMemoryAllocator::readUInt32(myLastEntryStart + 2);
-		const std::size_t newLen = oldLen + fullLength;
-		myLastEntryStart = myAllocator->reallocateLast(myLastEntryStart, 2 * newLen + 6);
-		ZLCachedMemoryAllocator::writeUInt32(myLastEntryStart + 2, newLen);
-		std::size_t offset = 6 + oldLen;
-		for (std::vector<std::string>::const_iterator it = text.begin(); it != text.end(); ++it) {
-			ZLUnicodeUtil::utf8ToUcs2(ucs2str, *it);
-			const std::size_t len = 2 * ucs2str.size();
-			std::memcpy(myLastEntryStart + offset, &ucs2str.front(), len);
-			offset += len;
-			ucs2str.clear();
-		}
+		oldLen = ZLCachedMemoryAllocator::readUInt32(myLastEntryStart + 2);
+		myLastEntryStart = myAllocator->reallocateLast(myLastEntryStart, 2 * (oldLen + maxLen) + 6);
 	} else {
-		myLastEntryStart = myAllocator->allocate(2 * fullLength + 6);
+		myLastEntryStart = myAllocator->allocate(2 * maxLen + 6);
 		*myLastEntryStart = ZLTextParagraphEntry::TEXT_ENTRY;
 		*(myLastEntryStart + 1) = 0;
-		ZLCachedMemoryAllocator::writeUInt32(myLastEntryStart + 2, fullLength);
-		std::size_t offset = 6;
-		for (std::vector<std::string>::const_iterator it = text.begin(); it != text.end(); ++it) {
-			ZLUnicodeUtil::utf8ToUcs2(ucs2str, *it);
-			const std::size_t len = 2 * ucs2str.size();
-			std::memcpy(myLastEntryStart + offset, &ucs2str.front(), len);
-			offset += len;
-			ucs2str.clear();
-		}
-		myParagraphs.back()->addEntry(myLastEntryStart);
-		++myParagraphLengths.back();
+		++myParagraphs.lastLength();
 	}
-	myTextSizes.back() += fullLength;
+
+	ZLUnicodeUtil::Ucs2Char *ucs2data = (ZLUnicodeUtil::Ucs2Char*)(myLastEntryStart + 6) + oldLen;
+	std::size_t len = 0;
+	for (std::size_t i = 0; i < count; ++i) {
+		len += ZLUnicodeUtil::utf8ToUcs2(ucs2data + len, data[i], lengths[i]);
+	}
+	if (len < maxLen) {
+		myLastEntryStart = myAllocator->reallocateLast(myLastEntryStart, 2 * (oldLen + len) + 6);
+	}
+	ZLCachedMemoryAllocator::writeUInt32(myLastEntryStart + 2, oldLen + len);
+	myParagraphs.lastTextSize() += len;
 }
 
 void ZLTextModel::addFixedHSpace(unsigned char length) {
@@ -218,8 +252,7 @@ void ZLTextModel::addFixedHSpace(unsigned char length) {
 	*(myLastEntryStart + 1) = 0;
 	*(myLastEntryStart + 2) = length;
 	*(myLastEntryStart + 3) = 0;
-	myParagraphs.back()->addEntry(myLastEntryStart);
-	++myParagraphLengths.back();
+	++myParagraphs.lastLength();
 }
 
 void ZLTextModel::addControl(ZLTextKind textKind, bool isStart) {
@@ -228,14 +261,15 @@ void ZLTextModel::addControl(ZLTextKind textKind, bool isStart) {
 	*(myLastEntryStart + 1) = 0;
 	*(myLastEntryStart + 2) = textKind;
 	*(myLastEntryStart + 3) = isStart ? 1 : 0;
-	myParagraphs.back()->addEntry(myLastEntryStart);
-	++myParagraphLengths.back();
+	++myParagraphs.lastLength();
 }
 
+static const std::size_t MAX_STYLE_REFERENCE = 0xFFFF;
+
 //static int EntryCount = 0;
 //static int EntryLen = 0;
 
-void ZLTextModel::addStyleEntry(const ZLTextStyleEntry &entry) {
+void ZLTextModel::writeStyleEntry(std::string &data, const ZLTextStyleEntry &entry) {
 	// +++ calculating entry size
 	std::size_t len = 4; // entry type + feature mask
 	for (int i = 0; i < ZLTextStyleEntry::NUMBER_OF_LENGTHS; ++i) {
@@ -267,8 +301,9 @@ void ZLTextModel::addStyleEntry(const ZLTextStyleEntry &entry) {
 */
 
 	// +++ writing entry
-	myLastEntryStart = myAllocator->allocate(len);
-	char *address = myLastEntryStart;
+	const std::size_t offset = data.size();
+	data.resize(offset + len);
+	char *address = &data[offset];
 
 	*address++ = entry.entryKind();
 	*address++ = 0;
@@ -294,9 +329,51 @@ void ZLTextModel::addStyleEntry(const ZLTextStyleEntry &entry) {
 		*address++ = entry.myFontModifier;
 	}
 	// --- writing entry
+}
+
+// the entry fields as they are, without converting the font family
+void ZLTextModel::makeStyleKey(std::string &key, const ZLTextStyleEntry &entry) {
+	key.assign(1, entry.entryKind());
+	key.append((const char*)&entry.myFeatureMask, sizeof(entry.myFeatureMask));
+	for (int i = 0; i < ZLTextStyleEntry::NUMBER_OF_LENGTHS; ++i) {
+		if (entry.isFeatureSupported((ZLTextStyleEntry::Feature)i)) {
+			const ZLTextStyleEntry::LengthType &len = entry.myLengths[i];
+			key.append((const char*)&len.Size, sizeof(len.Size));
+			key += (char)len.Unit;
+		}
+	}
+	key += (char)entry.myAlignmentType;
+	key += (char)entry.mySupportedFontModifier;
+	key += (char)entry.myFontModifier;
+	if (entry.isFeatureSupported(ZLTextStyleEntry::FONT_FAMILY)) {
+		key.append(entry.myFontFamily);
+	}
+}
 
-	myParagraphs.back()->addEntry(myLastEntryStart);
-	++myParagraphLengths.back();
+void ZLTextModel::addStyleEntry(const ZLTextStyleEntry &entry) {
+	// paragraphs repeat the same few styles, so each one is written
+	// into the style table once and referenced by its number
+	makeStyleKey(myStyleKey, entry);
+	std::map<std::string,unsigned short>::const_iterator it = myStyleIds.find(myStyleKey);
+	if (it == myStyleIds.end()) {
+		if (myStyleIds.size() == MAX_STYLE_REFERENCE) {
+			// the table is full, the entry is written in place
+			std::string data;
+			writeStyleEntry(data, entry);
+			myLastEntryStart = myAllocator->allocate(data.size());
+			std::memcpy(myLastEntryStart, data.data(), data.size());
+			++myParagraphs.lastLength();
+			return;
+		}
+		it = myStyleIds.insert(std::make_pair(myStyleKey, (unsigned short)myStyleIds.size())).first;
+		writeStyleEntry(myStyleTable, entry);
+	}
+
+	myLastEntryStart = myAllocator->allocate(4);
+	*myLastEntryStart = ZLTextParagraphEntry::STYLE_REFERENCE_ENTRY;
+	*(myLastEntryStart + 1) = 0;
+	ZLCachedMemoryAllocator::writeUInt16(myLastEntryStart + 2, it->second);
+	++myParagraphs.lastLength();
 }
 
 void ZLTextModel::addStyleCloseEntry() {
@@ -306,8 +383,7 @@ void ZLTextModel::addStyleCloseEntry() {
 	*address++ = ZLTextParagraphEntry::STYLE_CLOSE_ENTRY;
 	*address++ = 0;
 
-	myParagraphs.back()->addEntry(myLastEntryStart);
-	++myParagraphLengths.back();
+	++myParagraphs.lastLength();
 }
 
 void ZLTextModel::addHyperlinkControl(ZLTextKind textKind, ZLHyperlinkType hyperlinkType, const std::string &label) {
@@ -323,8 +399,7 @@ void ZLTextModel::addHyperlinkControl(ZLTextKind textKind, ZLHyperlinkType hyper
 	*(myLastEntryStart + 3) = hyperlinkType;
 	ZLCachedMemoryAllocator::writeUInt16(myLastEntryStart + 4, ucs2label.size());
 	std::memcpy(myLastEntryStart + 6, &ucs2label.front(), len);
-	myParagraphs.back()->addEntry(myLastEntryStart);
-	++myParagraphLengths.back();
+	++myParagraphs.lastLength();
 }
 
 void ZLTextModel::addImage(const std::string &id, short vOffset, bool isCover) {
@@ -340,16 +415,14 @@ void ZLTextModel::addImage(const std::string &id, short vOffset, bool isCover) {
 	ZLCachedMemoryAllocator::writeUInt16(myLastEntryStart + 4, ucs2id.size());
 	std::memcpy(myLastEntryStart + 6, &ucs2id.front(), len);
 	ZLCachedMemoryAllocator::writeUInt16(myLastEntryStart + 6 + len, isCover ? 1 : 0);
-	myParagraphs.back()->addEntry(myLastEntryStart);
-	++myParagraphLengths.back();
+	++myParagraphs.lastLength();
 }
 
 void ZLTextModel::addBidiReset() {
 	myLastEntryStart = myAllocator->allocate(2);
 	*myLastEntryStart = ZLTextParagraphEntry::RESET_BIDI_ENTRY;
 	*(myLastEntryStart + 1) = 0;
-	myParagraphs.back()->addEntry(myLastEntryStart);
-	++myParagraphLengths.back();
+	++myParagraphs.lastLength();
 }
 
 void ZLTextModel::flush() {
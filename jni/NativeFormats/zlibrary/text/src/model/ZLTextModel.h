@@ -23,6 +23,7 @@
 #include <jni.h>
 
 #include <vector>
+#include <map>
 #include <string>
 #include <algorithm>
 
@@ -34,6 +35,48 @@
 
 class ZLTextStyleEntry;
 
+// Paragraph properties as a struct of arrays. The columns share a single
+// block that doubles when full, so adding a paragraph allocates nothing in
+// most cases, and every column is ready to be copied into a Java array.
+class ZLTextParagraphArena {
+
+public:
+	ZLTextParagraphArena();
+	~ZLTextParagraphArena();
+
+	std::size_t size() const;
+	void add(jint startEntryIndex, jint startEntryOffset, jbyte kind);
+
+	const jint *startEntryIndices() const;
+	const jint *startEntryOffsets() const;
+	const jint *paragraphLengths() const;
+	const jint *textSizes() const;
+	const jbyte *paragraphKinds() const;
+
+	// the last paragraph's entry count and cumulative text size
+	jint &lastLength();
+	jint &lastTextSize();
+
+private:
+	void grow();
+
+private:
+	char *myBlock;
+	std::size_t mySize;
+	std::size_t myCapacity;
+
+	// point into myBlock
+	jint *myStartEntryIndices;
+	jint *myStartEntryOffsets;
+	jint *myParagraphLengths;
+	jint *myTextSizes;
+	jbyte *myParagraphKinds;
+
+private:
+	ZLTextParagraphArena(const ZLTextParagraphArena&);
+	const ZLTextParagraphArena &operator = (const ZLTextParagraphArena&);
+};
+
 class ZLTextModel {
 
 protected:
@@ -50,8 +93,7 @@ public:
 	//bool isRtl() const;
 
 	std::size_t paragraphsNumber() const;
-	ZLTextParagraph *operator [] (std::size_t index);
-	const ZLTextParagraph *operator [] (std::size_t index) const;
+	ZLTextParagraph operator [] (std::size_t index) const;
 /*
 	const std::vector<ZLTextMark> &marks() const;
 
@@ -78,29 +120,39 @@ public:
 
 	const ZLCachedMemoryAllocator &allocator() const;
 
-	const std::vector<jint> &startEntryIndices() const;
-	const std::vector<jint> &startEntryOffsets() const;
-	const std::vector<jint> &paragraphLengths() const;
-	const std::vector<jint> &textSizes() const;
-	const std::vector<jbyte> &paragraphKinds() const;
+	// paragraphsNumber() elements each
+	const jint *startEntryIndices() const;
+	const jint *startEntryOffsets() const;
+	const jint *paragraphLengths() const;
+	const jint *textSizes() const;
+	const jbyte *paragraphKinds() const;
+	// style entries referenced from paragraphs, in the paragraph entry format
+	const std::string &styleTable() const;
 
 protected:
-	void addParagraphInternal(ZLTextParagraph *paragraph);
+	void addParagraphInternal(ZLTextParagraph::Kind kind);
+
+private:
+	void addText(const char *const *data, const std::size_t *lengths, std::size_t count);
+	static void writeStyleEntry(std::string &data, const ZLTextStyleEntry &entry);
+	static void makeStyleKey(std::string &key, const ZLTextStyleEntry &entry);
 
 private:
 	const std::string myId;
 	const std::string myLanguage;
-	std::vector<ZLTextParagraph*> myParagraphs;
+	ZLTextParagraphArena myParagraphs;
 	//mutable std::vector<ZLTextMark> myMarks;
 	mutable shared_ptr<ZLCachedMemoryAllocator> myAllocator;
 
 	char *myLastEntryStart;
 
-	std::vector<jint> myStartEntryIndices;
-	std::vector<jint> myStartEntryOffsets;
-	std::vector<jint> myParagraphLengths;
-	std::vector<jint> myTextSizes;
-	std::vector<jbyte> myParagraphKinds;
+	std::string myStyleTable;
+	std::map<std::string,unsigned short> myStyleIds;
+	std::string myStyleKey;
+
+	// buffers reused by addText()
+	std::vector<const char*> myTextData;
+	std::vector<std::size_t> myTextLengths;
 
 private:
 	ZLTextModel(const ZLTextModel&);
@@ -117,24 +169,30 @@ public:
 	void createParagraph(ZLTextParagraph::Kind kind);
 };
 
+inline std::size_t ZLTextParagraphArena::size() const { return mySize; }
+inline const jint *ZLTextParagraphArena::startEntryIndices() const { return myStartEntryIndices; }
+inline const jint *ZLTextParagraphArena::startEntryOffsets() const { return myStartEntryOffsets; }
+inline const jint *ZLTextParagraphArena::paragraphLengths() const { return myParagraphLengths; }
+inline const jint *ZLTextParagraphArena::textSizes() const { return myTextSizes; }
+inline const jbyte *ZLTextParagraphArena::paragraphKinds() const { return myParagraphKinds; }
+inline jint &ZLTextParagraphArena::lastLength() { return myParagraphLengths[mySize - 1]; }
+inline jint &ZLTextParagraphArena::lastTextSize() { return myTextSizes[mySize - 1]; }
+
 inline const std::string &ZLTextModel::id() const { return myId; }
 inline const std::string &ZLTextModel::language() const { return myLanguage; }
 inline std::size_t ZLTextModel::paragraphsNumber() const { return myParagraphs.size(); }
 //inline const std::vector<ZLTextMark> &ZLTextModel::marks() const { return myMarks; }
 //inline void ZLTextModel::removeAllMarks() { myMarks.clear(); }
 inline const ZLCachedMemoryAllocator &ZLTextModel::allocator() const { return *myAllocator; }
-inline const std::vector<jint> &ZLTextModel::startEntryIndices() const { return myStartEntryIndices; }
-inline const std::vector<jint> &ZLTextModel::startEntryOffsets() const { return myStartEntryOffsets; }
-inline const std::vector<jint> &ZLTextModel::paragraphLengths() const { return myParagraphLengths; };
-inline const std::vector<jint> &ZLTextModel::textSizes() const { return myTextSizes; };
-inline const std::vector<jbyte> &ZLTextModel::paragraphKinds() const { return myParagraphKinds; };
-
-inline ZLTextParagraph *ZLTextModel::operator [] (std::size_t index) {
-	return myParagraphs[std::min(myParagraphs.size() - 1, index)];
-}
-
-inline const ZLTextParagraph *ZLTextModel::operator [] (std::size_t index) const {
-	return myParagraphs[std::min(myParagraphs.size() - 1, index)];
+inline const jint *ZLTextModel::startEntryIndices() const { return myParagraphs.startEntryIndices(); }
+inline const jint *ZLTextModel::startEntryOffsets() const { return myParagraphs.startEntryOffsets(); }
+inline const jint *ZLTextModel::paragraphLengths() const { return myParagraphs.paragraphLengths(); }
+inline const jint *ZLTextModel::textSizes() const { return myParagraphs.textSizes(); }
+inline const jbyte *ZLTextModel::paragraphKinds() const { return myParagraphs.paragraphKinds(); }
+inline const std::string &ZLTextModel::styleTable() const { return myStyleTable; }
+
+inline ZLTextParagraph ZLTextModel::operator [] (std::size_t index) const {
+	return ZLTextParagraph(myParagraphs.paragraphKinds(), myParagraphs.paragraphLengths(), std::min(myParagraphs.size() - 1, index));
 }
 
 #endif /* __ZLTEXTMODEL_H__ */
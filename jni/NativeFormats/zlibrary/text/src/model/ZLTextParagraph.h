@@ -20,6 +20,8 @@
 #ifndef __ZLTEXTPARAGRAPH_H__
 #define __ZLTEXTPARAGRAPH_H__
 
+#include <jni.h>
+
 #include <map>
 #include <vector>
 #include <string>
@@ -46,6 +48,7 @@ public:
 		STYLE_CLOSE_ENTRY = 7,
 		FIXED_HSPACE_ENTRY = 8,
 		RESET_BIDI_ENTRY = 9,
+		STYLE_REFERENCE_ENTRY = 10,
 	};
 
 protected:
@@ -184,43 +187,20 @@ public:
 		END_OF_TEXT_PARAGRAPH,
 	};
 
-protected:
-	ZLTextParagraph();
-
 public:
-	virtual ~ZLTextParagraph();
-	virtual Kind kind() const;
+	// is created by ZLTextModel; stays valid until a paragraph is added
+	ZLTextParagraph(const jbyte *kinds, const jint *lengths, std::size_t index);
 
+	Kind kind() const;
 	std::size_t entryNumber() const;
 
 	//std::size_t textDataLength() const;
 	//std::size_t characterNumber() const;
 
 private:
-	void addEntry(char *address);
-
-private:
-	char *myFirstEntryAddress;
-	std::size_t myEntryNumber;
-
-friend class Iterator;
-friend class ZLTextModel;
-friend class ZLTextPlainModel;
-};
-
-class ZLTextSpecialParagraph : public ZLTextParagraph {
-
-private:
-	ZLTextSpecialParagraph(Kind kind);
-
-public:
-	~ZLTextSpecialParagraph();
-	Kind kind() const;
-
-private:
-	Kind myKind;
-
-friend class ZLTextPlainModel;
+	const jbyte *myKinds;
+	const jint *myLengths;
+	const std::size_t myIndex;
 };
 
 inline ZLTextParagraphEntry::ZLTextParagraphEntry() {}
@@ -253,19 +233,13 @@ inline short ImageEntry::vOffset() const { return myVOffset; }
 
 inline ResetBidiEntry::ResetBidiEntry() {}
 
-inline ZLTextParagraph::ZLTextParagraph() : myEntryNumber(0) {}
-inline ZLTextParagraph::~ZLTextParagraph() {}
-inline ZLTextParagraph::Kind ZLTextParagraph::kind() const { return TEXT_PARAGRAPH; }
-inline std::size_t ZLTextParagraph::entryNumber() const { return myEntryNumber; }
-inline void ZLTextParagraph::addEntry(char *address) { if (myEntryNumber == 0) myFirstEntryAddress = address; ++myEntryNumber; }
+inline ZLTextParagraph::ZLTextParagraph(const jbyte *kinds, const jint *lengths, std::size_t index) : myKinds(kinds), myLengths(lengths), myIndex(index) {}
+inline ZLTextParagraph::Kind ZLTextParagraph::kind() const { return (Kind)myKinds[myIndex]; }
+inline std::size_t ZLTextParagraph::entryNumber() const { return myLengths[myIndex]; }
 
 //inline ZLTextParagraph::Iterator::Iterator(const ZLTextParagraph &paragraph) : myPointer(paragraph.myFirstEntryAddress), myIndex(0), myEndIndex(paragraph.entryNumber()) {}
 //inline ZLTextParagraph::Iterator::~Iterator() {}
 //inline bool ZLTextParagraph::Iterator::isEnd() const { return myIndex == myEndIndex; }
 //inline ZLTextParagraphEntry::Kind ZLTextParagraph::Iterator::entryKind() const { return (ZLTextParagraphEntry::Kind)*myPointer; }
 
-inline ZLTextSpecialParagraph::ZLTextSpecialParagraph(Kind kind) : myKind(kind) {}
-inline ZLTextSpecialParagraph::~ZLTextSpecialParagraph() {}
-inline ZLTextParagraph::Kind ZLTextSpecialParagraph::kind() const { return myKind; }
-
 #endif /* __ZLTEXTPARAGRAPH_H__ */
@@ -127,6 +127,13 @@ ZLInputStream *ZLAndroidFSManager::createPlainInputStream(const std::string &pat
 	return new JavaInputStream(path);
 }
 
+ZLInputStream *ZLAndroidFSManager::createMappedInputStream(const std::string &path) const {
+	if (useNativeImplementation(path)) {
+		return ZLUnixFSManager::createMappedInputStream(path);
+	}
+	return new JavaInputStream(path);
+}
+
 /*ZLOutputStream *ZLAndroidFSManager::createOutputStream(const std::string &path) const {
 	if (useNativeImplementation(path)) {
 		return ZLUnixFSManager::createOutputStream(path);
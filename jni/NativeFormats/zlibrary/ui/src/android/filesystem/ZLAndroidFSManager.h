@@ -44,6 +44,7 @@ protected: // Overridden methods
 	ZLFSDir *createNewDirectory(const std::string &path) const;
 	ZLFSDir *createPlainDirectory(const std::string &path) const;
 	ZLInputStream *createPlainInputStream(const std::string &path) const;
+	ZLInputStream *createMappedInputStream(const std::string &path) const;
 	//ZLOutputStream *createOutputStream(const std::string &path) const;
 	bool removeFile(const std::string &path) const;
 
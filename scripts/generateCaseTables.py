@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+#
+# Generates jni/NativeFormats/zlibrary/core/src/util/ZLUnicodeCaseTables.h,
+# two-level lookup tables for simple (one-to-one) Unicode case mapping
+# used by ZLUnicodeUtil::toLower/toUpper.
+#
+# Usage: scripts/generateCaseTables.py > jni/NativeFormats/zlibrary/core/src/util/ZLUnicodeCaseTables.h
+#
+# Each code point maps to a 16-bit delta; the mapped code point is
+# (ch & ~0xFFFF) | ((ch + delta) & 0xFFFF).  All simple case mappings
+# stay inside one plane, so 16 bits are enough.  Deltas are grouped
+# into blocks of 1 << SHIFT code points; identical blocks are shared.
+
+import sys
+import unicodedata
+
+SHIFT = 6
+BLOCK = 1 << SHIFT
+
+# Python exposes full case mappings only; these are the UnicodeData.txt
+# simple mappings for characters whose full mapping is longer than one char
+def simpleLower(ch):
+	if ch == '\u0130':
+		return 'i'
+	return ch.lower()
+
+def simpleUpper(ch):
+	mapped = ch.upper()
+	if len(mapped) != 1 and len(ch.title()) == 1:
+		return ch.title()
+	return mapped
+
+def mapping(function):
+	deltas = {}
+	for code in range(0x110000):
+		ch = chr(code)
+		mapped = function(ch)
+		# other multi-character results have no simple mapping; keep them as is
+		if len(mapped) != 1 or mapped == ch:
+			continue
+		if (ord(mapped) >> 16) != (code >> 16):
+			raise Exception('mapping crosses plane boundary: %x' % code)
+		deltas[code] = (ord(mapped) - code) & 0xFFFF
+	return deltas
+
+def tables(deltas):
+	limit = (max(deltas) >> SHIFT) + 1
+	blocks = [tuple([0] * BLOCK)]
+	index = []
+	for i in range(limit):
+		block = tuple(deltas.get((i << SHIFT) + j, 0) for j in range(BLOCK))
+		if block not in blocks:
+			blocks.append(block)
+		index.append(blocks.index(block))
+	if len(blocks) > 256:
+		raise Exception('too many blocks, increase SHIFT')
+	return index, blocks
+
+def emit(out, name, deltas):
+	index, blocks = tables(deltas)
+	out.write('static const std::size_t %sIndexSize = %d;\n\n' % (name, len(index)))
+	out.write('static const unsigned char %sIndex[%d] = {\n' % (name, len(index)))
+	for i in range(0, len(index), 16):
+		out.write('\t' + ', '.join('%d' % v for v in index[i:i + 16]) + ',\n')
+	out.write('};\n\n')
+	out.write('static const uint16_t %sBlocks[%d][%d] = {\n' % (name, len(blocks), BLOCK))
+	for block in blocks:
+		out.write('\t{\n')
+		for i in range(0, BLOCK, 8):
+			out.write('\t\t' + ', '.join('0x%04x' % v for v in block[i:i + 8]) + ',\n')
+		out.write('\t},\n')
+	out.write('};\n\n')
+
+out = sys.stdout
+out.write('''/*
+ * This file is generated by scripts/generateCaseTables.py
+ * from Unicode %s data; do not edit it manually.
+ */
+
+#ifndef __ZLUNICODECASETABLES_H__
+#define __ZLUNICODECASETABLES_H__
+
+#include <cstddef>
+#include <stdint.h>
+
+static const int CaseTableShift = %d;
+
+''' % (unicodedata.unidata_version, SHIFT))
+emit(out, 'LowerCase', mapping(simpleLower))
+emit(out, 'UpperCase', mapping(simpleUpper))
+out.write('#endif /* __ZLUNICODECASETABLES_H__ */\n')
@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+#
+# Generates jni/NativeFormats/fbreader/src/formats/util/TagNames.h and
+# TagNames.cpp, a perfect hash over the tag names known to the FB2, XHTML
+# and HTML readers.
+#
+# Usage:
+#   scripts/generateTagTables.py header > jni/NativeFormats/fbreader/src/formats/util/TagNames.h
+#   scripts/generateTagTables.py source > jni/NativeFormats/fbreader/src/formats/util/TagNames.cpp
+#
+# The hash is FNV-1a over the name with bit 0x20 set in every byte, so
+# ASCII letters hash the same in both cases.  Its top bits select one of
+# BUCKETS displacements; the slot is (hash + displacement) % SLOTS.
+# Seed and displacements are searched so that no two names share a slot.
+
+import sys
+
+FB2_TAGS = [
+	'p', 'ul', 'ol', 'li', 'subtitle', 'cite', 'text-author', 'date',
+	'section', 'v', 'title', 'poem', 'stanza', 'epigraph', 'annotation',
+	'sub', 'sup', 'code', 'strikethrough', 'strong', 'b', 'emphasis', 'i',
+	'a', 'image', 'binary', 'description', 'body', 'empty-line',
+	'title-info', 'book-title', 'author', 'lang', 'first-name',
+	'middle-name', 'last-name', 'coverpage', 'sequence', 'genre',
+	'document-info', 'id',
+]
+
+HTML_TAGS = [
+	'html', 'head', 'title', 'meta', 'script', 'style', 'link', 'base',
+	'body', 'font', 'p', 'h1', 'h2', 'h3', 'h4', 'h5', 'h6', 'ol', 'ul',
+	'dl', 'li', 'dt', 'dd', 'menu', 'dir', 'strong', 'b', 'em', 'i', 'code',
+	'tt', 'kbd', 'var', 'samp', 'cite', 'sub', 'sup', 'dfn', 'strike', 's',
+	'u', 'big', 'small', 'abbr', 'acronym', 'q', 'ins', 'del', 'a', 'img',
+	'object', 'param', 'svg', 'image', 'area', 'map', 'blockquote', 'br',
+	'center', 'div', 'span', 'hr', 'pre', 'table', 'caption', 'tr', 'td',
+	'th', 'select',
+]
+
+SLOTS = 256
+BUCKET_BITS = 6
+BUCKETS = 1 << BUCKET_BITS
+
+def hashValue(seed, name):
+	h = seed
+	for ch in name.encode('ascii'):
+		h = ((h ^ (ch | 0x20)) * 16777619) & 0xFFFFFFFF
+	return h
+
+def search(names):
+	for seed in range(2166136261, 2166136261 + 100000):
+		hashes = dict((name, hashValue(seed, name)) for name in names)
+		buckets = [[] for i in range(BUCKETS)]
+		for name in names:
+			buckets[hashes[name] >> (32 - BUCKET_BITS)].append(name)
+		slots = [None] * SLOTS
+		displacements = [0] * BUCKETS
+		order = sorted(range(BUCKETS), key=lambda b: -len(buckets[b]))
+		for b in order:
+			for d in range(SLOTS):
+				indices = [(hashes[name] + d) % SLOTS for name in buckets[b]]
+				if len(set(indices)) == len(indices) and all(slots[i] is None for i in indices):
+					for name, i in zip(buckets[b], indices):
+						slots[i] = name
+					displacements[b] = d
+					break
+			else:
+				break
+		else:
+			return seed, displacements, slots
+	raise Exception('no perfect hash found')
+
+def identifier(name):
+	return name.upper().replace('-', '_')
+
+names = sorted(set(FB2_TAGS + HTML_TAGS))
+seed, displacements, slots = search(names)
+
+HEADER = '''/*
+ * This file is generated by scripts/generateTagTables.py;
+ * do not edit it manually.
+ */
+
+'''
+
+def header(out):
+	out.write(HEADER)
+	out.write('#ifndef __TAGNAMES_H__\n#define __TAGNAMES_H__\n\n')
+	out.write('#include <cstddef>\n#include <string>\n\n')
+	out.write('class TagNames {\n\npublic:\n\tenum Id {\n')
+	for name in names:
+		out.write('\t\t%s,\n' % identifier(name))
+	out.write('\t\tUNKNOWN\n\t};\n\n')
+	out.write('''public:
+	// ASCII letters are compared ignoring case; UNKNOWN if the name is not in the table
+	static Id id(const char *name, std::size_t length);
+	static Id id(const char *name);
+	static Id id(const std::string &name);
+	// the part after the namespace prefix, if any
+	static Id localId(const char *name);
+	// lower case name
+	static const char *name(Id id);
+};
+
+#endif /* __TAGNAMES_H__ */
+''')
+
+def source(out):
+	out.write(HEADER)
+	out.write('#include <cstring>\n#include <stdint.h>\n\n#include "TagNames.h"\n\n')
+	out.write('static const std::size_t MAX_LENGTH = %d;\n\n' % max(len(name) for name in names))
+	out.write('static const char *const NAMES[%d] = {\n' % len(names))
+	for name in names:
+		out.write('\t"%s",\n' % name)
+	out.write('};\n\n')
+	out.write('static const unsigned char LENGTHS[%d] = {\n' % len(names))
+	for i in range(0, len(names), 16):
+		out.write('\t' + ', '.join('%d' % len(name) for name in names[i:i + 16]) + ',\n')
+	out.write('};\n\n')
+	out.write('static const unsigned char DISPLACEMENTS[%d] = {\n' % BUCKETS)
+	for i in range(0, BUCKETS, 16):
+		out.write('\t' + ', '.join('%d' % d for d in displacements[i:i + 16]) + ',\n')
+	out.write('};\n\n')
+	out.write('// id + 1, 0 for empty slots\n')
+	out.write('static const unsigned char SLOTS[%d] = {\n' % SLOTS)
+	values = [0 if name is None else names.index(name) + 1 for name in slots]
+	for i in range(0, SLOTS, 16):
+		out.write('\t' + ', '.join('%d' % v for v in values[i:i + 16]) + ',\n')
+	out.write('};\n\n')
+	out.write('''TagNames::Id TagNames::id(const char *name, std::size_t length) {
+	if (length == 0 || length > MAX_LENGTH) {
+		return UNKNOWN;
+	}
+	uint32_t hash = %uU;
+	for (std::size_t i = 0; i < length; ++i) {
+		hash = (hash ^ ((unsigned char)name[i] | 0x20)) * 16777619U;
+	}
+	const int index = SLOTS[(hash + DISPLACEMENTS[hash >> %d]) & %d] - 1;
+	if (index < 0 || LENGTHS[index] != length) {
+		return UNKNOWN;
+	}
+	const char *candidate = NAMES[index];
+	for (std::size_t i = 0; i < length; ++i) {
+		char ch = name[i];
+		if (ch >= 'A' && ch <= 'Z') {
+			ch += 'a' - 'A';
+		}
+		if (ch != candidate[i]) {
+			return UNKNOWN;
+		}
+	}
+	return (Id)index;
+}
+
+TagNames::Id TagNames::id(const char *name) {
+	return id(name, std::strlen(name));
+}
+
+TagNames::Id TagNames::id(const std::string &name) {
+	return id(name.data(), name.length());
+}
+
+TagNames::Id TagNames::localId(const char *name) {
+	const char *colon = std::strchr(name, ':');
+	return id(colon != 0 ? colon + 1 : name);
+}
+
+const char *TagNames::name(Id id) {
+	return id != UNKNOWN ? NAMES[id] : "";
+}
+''' % (seed, 32 - BUCKET_BITS, SLOTS - 1))
+
+if len(sys.argv) != 2 or sys.argv[1] not in ('header', 'source'):
+	sys.stderr.write('usage: %s header|source\n' % sys.argv[0])
+	sys.exit(1)
+if sys.argv[1] == 'header':
+	header(sys.stdout)
+else:
+	source(sys.stdout)
@@ -0,0 +1,309 @@
+/*
+ * Copyright (C) 2004-2014 Geometer Plus <contact@geometerplus.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+// Differential test of the block-scanning UTF-8 functions of ZLUnicodeUtil
+// (asciiLength, isUtf8String, utf8Length, both utf8ToUcs2 overloads)
+// against the byte-at-a-time code they replaced, copied below (without
+// the 4-byte ASCII loop the pointer utf8ToUcs2 already had).
+// Built and run on the host by scripts/testUnicodeUtil.sh.
+//
+// Inputs:
+//  - every string of up to 3 bytes;
+//  - every position of valid and broken sequences inside ASCII runs
+//    of 0..80 bytes, at every start alignment within a machine word;
+//  - pseudo-random strings of mostly ASCII, Cyrillic and stray bytes.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <string>
+
+#include <ZLUnicodeUtil.h>
+
+namespace Scalar {
+
+typedef ZLUnicodeUtil::Ucs2Char Ucs2Char;
+typedef ZLUnicodeUtil::Ucs2String Ucs2String;
+
+static std::size_t asciiLength(const char *str, std::size_t len) {
+	std::size_t i = 0;
+	while (i < len && (str[i] & 0x80) == 0) {
+		++i;
+	}
+	return i;
+}
+
+static bool isUtf8String(const char *str, int len) {
+	const char *last = str + len;
+	int nonLeadingCharsCounter = 0;
+	for (; str < last; ++str) {
+		if (nonLeadingCharsCounter == 0) {
+			if ((*str & 0x80) != 0) {
+				if ((*str & 0xE0) == 0xC0) {
+					nonLeadingCharsCounter = 1;
+				} else if ((*str & 0xF0) == 0xE0) {
+					nonLeadingCharsCounter = 2;
+				} else if ((*str & 0xF8) == 0xF0) {
+					nonLeadingCharsCounter = 3;
+				} else {
+					return false;
+				}
+			}
+		} else {
+			if ((*str & 0xC0) != 0x80) {
+				return false;
+			}
+			--nonLeadingCharsCounter;
+		}
+	}
+	return nonLeadingCharsCounter == 0;
+}
+
+static int utf8Length(const char *str, int len) {
+	const char *last = str + len;
+	int counter = 0;
+	while (str < last) {
+		if ((*str & 0x80) == 0) {
+			++str;
+		} else if ((*str & 0x20) == 0) {
+			str += 2;
+		} else if ((*str & 0x10) == 0) {
+			str += 3;
+		} else {
+			str += 4;
+		}
+		++counter;
+	}
+	return counter;
+}
+
+// reads up to 2 bytes past the end of a cut sequence; the caller pads with zeros
+static void utf8ToUcs2(Ucs2String &to, const char *from, int length) {
+	to.clear();
+	to.reserve(utf8Length(from, length));
+	const char *last = from + length;
+	for (const char *ptr = from; ptr < last;) {
+		if ((*ptr & 0x80) == 0) {
+			to.push_back(*ptr);
+			++ptr;
+		} else if ((*ptr & 0x20) == 0) {
+			Ucs2Char ch = *ptr & 0x1f;
+			++ptr;
+			ch <<= 6;
+			ch += *ptr & 0x3f;
+			to.push_back(ch);
+			++ptr;
+		} else if ((*ptr & 0x10) == 0) {
+			Ucs2Char ch = *ptr & 0x0f;
+			++ptr;
+			ch <<= 6;
+			ch += *ptr & 0x3f;
+			++ptr;
+			ch <<= 6;
+			ch += *ptr & 0x3f;
+			to.push_back(ch);
+			++ptr;
+		} else {
+			// symbol number is > 0xffff :(
+			to.push_back('X');
+			ptr += 4;
+		}
+	}
+}
+
+static std::size_t utf8ToUcs2(Ucs2Char *to, const char *from, std::size_t length) {
+	Ucs2Char *start = to;
+	const char *last = from + length;
+	const char *ptr = from;
+	while (ptr < last) {
+		// bytes missing at the end count as zeros
+		const unsigned char lead = *ptr;
+		if ((lead & 0x80) == 0) {
+			*to++ = lead;
+			++ptr;
+		} else if ((lead & 0x20) == 0) {
+			Ucs2Char ch = lead & 0x1f;
+			ch <<= 6;
+			if (last - ptr > 1) {
+				ch += ptr[1] & 0x3f;
+			}
+			*to++ = ch;
+			ptr += 2;
+		} else if ((lead & 0x10) == 0) {
+			Ucs2Char ch = lead & 0x0f;
+			ch <<= 6;
+			if (last - ptr > 1) {
+				ch += ptr[1] & 0x3f;
+			}
+			ch <<= 6;
+			if (last - ptr > 2) {
+				ch += ptr[2] & 0x3f;
+			}
+			*to++ = ch;
+			ptr += 3;
+		} else {
+			// symbol number is > 0xffff :(
+			*to++ = 'X';
+			ptr += 4;
+		}
+	}
+	return to - start;
+}
+
+}
+
+static long ourChecked = 0;
+static long ourFailed = 0;
+
+static void report(const char *function, const char *str, std::size_t len) {
+	if (++ourFailed > 20) {
+		return;
+	}
+	std::fprintf(stderr, "%s differs on", function);
+	for (std::size_t i = 0; i < len; ++i) {
+		std::fprintf(stderr, " %02x", (unsigned char)str[i]);
+	}
+	std::fprintf(stderr, "\n");
+}
+
+// str is followed by at least 3 zero bytes
+static void check(const char *str, std::size_t len) {
+	++ourChecked;
+	if (ZLUnicodeUtil::asciiLength(str, len) != Scalar::asciiLength(str, len)) {
+		report("asciiLength", str, len);
+	}
+	if (ZLUnicodeUtil::isUtf8String(str, len) != Scalar::isUtf8String(str, len)) {
+		report("isUtf8String", str, len);
+	}
+	if (ZLUnicodeUtil::utf8Length(str, len) != Scalar::utf8Length(str, len)) {
+		report("utf8Length", str, len);
+	}
+
+	ZLUnicodeUtil::Ucs2String actual, expected;
+	ZLUnicodeUtil::utf8ToUcs2(actual, str, len);
+	Scalar::utf8ToUcs2(expected, str, len);
+	if (actual != expected) {
+		report("utf8ToUcs2(Ucs2String&)", str, len);
+	}
+
+	static ZLUnicodeUtil::Ucs2Char actualBuffer[1024], expectedBuffer[1024];
+	const std::size_t actualLength = ZLUnicodeUtil::utf8ToUcs2(actualBuffer, str, len);
+	const std::size_t expectedLength = Scalar::utf8ToUcs2(expectedBuffer, str, len);
+	if (actualLength != expectedLength ||
+			std::memcmp(actualBuffer, expectedBuffer, actualLength * sizeof(ZLUnicodeUtil::Ucs2Char)) != 0) {
+		report("utf8ToUcs2(Ucs2Char*)", str, len);
+	}
+}
+
+static void checkShortStrings() {
+	char buffer[8] = { 0 };
+	check(buffer, 0);
+	for (int a = 0; a < 256; ++a) {
+		buffer[0] = a;
+		check(buffer, 1);
+		for (int b = 0; b < 256; ++b) {
+			buffer[1] = b;
+			check(buffer, 2);
+			for (int c = 0; c < 256; ++c) {
+				buffer[2] = c;
+				check(buffer, 3);
+			}
+			buffer[2] = 0;
+		}
+		buffer[1] = 0;
+	}
+}
+
+static const char *const SEQUENCES[] = {
+	"\xc3\xa9",             // 2 bytes
+	"\xd0\xaf\xd1\x8f",     // two 2-byte characters
+	"\xe2\x80\x94",         // 3 bytes
+	"\xf0\x9f\x98\x80",     // 4 bytes
+	"\x80",                 // stray continuation byte
+	"\xbf\xbf",
+	"\xc3",                 // cut sequences
+	"\xe2\x80",
+	"\xf0\x9f\x98",
+	"\xc3\x41",             // lead followed by ASCII
+	"\xe2\x41\x80",
+	"\xf8\x88\x80\x80\x80", // 5-byte form
+	"\xff",
+	"\x7f\x80",
+};
+
+static void checkSequencesInAsciiRuns() {
+	for (std::size_t s = 0; s < sizeof(SEQUENCES) / sizeof(SEQUENCES[0]); ++s) {
+		const std::string sequence = SEQUENCES[s];
+		for (std::size_t run = 0; run <= 80; ++run) {
+			for (std::size_t position = 0; position <= run; ++position) {
+				for (std::size_t align = 0; align < sizeof(unsigned long); ++align) {
+					std::string str(align, '.');
+					for (std::size_t i = 0; i < position; ++i) {
+						str += (char)('a' + i % 26);
+					}
+					str += sequence;
+					for (std::size_t i = position; i < run; ++i) {
+						str += (char)('A' + i % 26);
+					}
+					str.append(4, '\0');
+					check(str.data() + align, str.size() - 4 - align);
+				}
+			}
+		}
+	}
+}
+
+static unsigned long ourSeed = 12345;
+
+static unsigned long nextRandom() {
+	ourSeed = ourSeed * 1103515245 + 12345;
+	return (ourSeed >> 16) & 0x7fff;
+}
+
+static void checkRandomStrings(int number) {
+	for (int n = 0; n < number; ++n) {
+		const std::size_t length = nextRandom() % 300;
+		std::string str;
+		while (str.size() < length) {
+			const unsigned long kind = nextRandom() % 100;
+			if (kind < 70) {
+				str += (char)(0x20 + nextRandom() % 0x5f);
+			} else if (kind < 90) {
+				str += (char)0xd0;
+				str += (char)(0x90 + nextRandom() % 0x30);
+			} else if (kind < 95) {
+				str += "\xe2\x80\x94";
+			} else {
+				str += (char)(nextRandom() % 256);
+			}
+		}
+		str.resize(length);
+		str.append(4, '\0');
+		check(str.data(), length);
+	}
+}
+
+int main() {
+	checkShortStrings();
+	checkSequencesInAsciiRuns();
+	checkRandomStrings(300000);
+	std::printf("%ld strings checked, %ld differences\n", ourChecked, ourFailed);
+	return ourFailed == 0 ? 0 : 1;
+}
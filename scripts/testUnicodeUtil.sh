@@ -0,0 +1,28 @@
+#!/bin/sh
+#
+# Builds scripts/testUnicodeUtil.cpp with ZLUnicodeUtil.cpp for the host
+# and runs it; exits non-zero if the new UTF-8 functions differ from the
+# scalar ones on any input.
+#
+# Usage: scripts/testUnicodeUtil.sh [compiler flags]
+#
+# jni.h is taken from $JAVA_HOME/include.  Only the UTF-8 functions are
+# called, so the JNI and XML symbols ZLUnicodeUtil.cpp refers to are left
+# unresolved (which needs a non-PIE executable).  The vector path tested is the host's: SSE2 on x86, NEON on
+# ARM; the word-at-a-time path is covered by the tails of every block.
+
+CXX=${CXX:-g++}
+NF=jni/NativeFormats
+OUT=${TMPDIR:-/tmp}/testUnicodeUtil
+
+$CXX -O2 "$@" \
+	-I"$JAVA_HOME/include" -I"$JAVA_HOME/include/linux" \
+	-I$NF/util \
+	-I$NF/zlibrary/core/src/util \
+	-I$NF/zlibrary/core/src/library \
+	-I$NF/zlibrary/core/src/filesystem \
+	-I$NF/zlibrary/core/src/encryption \
+	-I$NF/zlibrary/core/src/xml \
+	scripts/testUnicodeUtil.cpp $NF/zlibrary/core/src/util/ZLUnicodeUtil.cpp \
+	-no-pie -Wl,--unresolved-symbols=ignore-all -o $OUT || exit 1
+$OUT
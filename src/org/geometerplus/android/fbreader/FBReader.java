@@ -815,6 +815,11 @@ public final class FBReader extends Activity implements ZLApplicationWindow {
 		UIUtil.runWithMessage(this, key, action, postAction, false);
 	}
 
+	@Override
+	public void hideMessage() {
+		UIUtil.hideMessage(this);
+	}
+
 	private int myBatteryLevel;
 	@Override
 	public int getBatteryLevel() {
@@ -60,8 +60,11 @@ class ProcessHyperlinkAction extends FBAndroidAction {
 					openInBrowser(hyperlink.Id);
 					break;
 				case FBHyperlinkType.INTERNAL:
-					Reader.Collection.markHyperlinkAsVisited(Reader.Model.Book, hyperlink.Id);
-					Reader.tryOpenFootnote(hyperlink.Id);
+					// no labels until the book is read completely
+					if (Reader.Model != null) {
+						Reader.Collection.markHyperlinkAsVisited(Reader.Model.Book, hyperlink.Id);
+						Reader.tryOpenFootnote(hyperlink.Id);
+					}
 					break;
 			}
 		} else if (soul instanceof ZLTextImageRegionSoul) {
@@ -35,6 +35,11 @@ public class SelectionBookmarkAction extends FBAndroidAction {
 		super(baseApplication, fbreader);
 	}
 
+	@Override
+	public boolean isEnabled() {
+		return Reader.Model != null;
+	}
+
 	@Override
 	protected void run(Object ... params) {
 		final boolean existingBookmark;
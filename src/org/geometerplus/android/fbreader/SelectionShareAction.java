@@ -30,6 +30,11 @@ public class SelectionShareAction extends FBAndroidAction {
 		super(baseActivity, fbreader);
 	}
 
+	@Override
+	public boolean isEnabled() {
+		return Reader.Model != null;
+	}
+
 	@Override
 	protected void run(Object ... params) {
 		final String text = Reader.getTextView().getSelectedText();
@@ -45,6 +45,8 @@ public abstract class UIUtil {
 	};
 	private static final Queue<Pair> ourTaskQueue = new LinkedList<Pair>();
 	private static volatile Handler ourProgressHandler;
+	private static final ThreadLocal<ProgressDialog> ourRunnerProgress =
+		new ThreadLocal<ProgressDialog>();
 
 	private static boolean init() {
 		if (ourProgressHandler != null) {
@@ -117,7 +119,9 @@ public abstract class UIUtil {
 
 				final Thread runner = new Thread() {
 					public void run() {
+						ourRunnerProgress.set(progress);
 						action.run();
+						ourRunnerProgress.set(null);
 						activity.runOnUiThread(new Runnable() {
 							public void run() {
 								try {
@@ -140,6 +144,26 @@ public abstract class UIUtil {
 		});
 	}
 
+	// closes the message of runWithMessage() before the action ends;
+	// should be called from the action; the action goes on running,
+	// and postAction is run when it ends, as usual
+	public static void hideMessage(Activity activity) {
+		final ProgressDialog progress = ourRunnerProgress.get();
+		if (progress == null) {
+			return;
+		}
+		ourRunnerProgress.set(null);
+		activity.runOnUiThread(new Runnable() {
+			public void run() {
+				try {
+					progress.dismiss();
+				} catch (Exception e) {
+					e.printStackTrace();
+				}
+			}
+		});
+	}
+
 	public static void showMessageText(final Activity activity, final String text) {
 		activity.runOnUiThread(new Runnable() {
 			public void run() {
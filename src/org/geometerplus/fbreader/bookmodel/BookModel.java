@@ -28,6 +28,10 @@ import org.geometerplus.fbreader.formats.FormatPlugin;
 
 public abstract class BookModel {
 	public static BookModel createModel(Book book) throws BookReadingException {
+		return createModel(book, null);
+	}
+
+	public static BookModel createModel(Book book, PrefixListener listener) throws BookReadingException {
 		final FormatPlugin plugin = book.getPlugin();
 
 		System.err.println("using plugin: " + plugin.supportedFileType() + "/" + plugin.type());
@@ -46,7 +50,9 @@ public abstract class BookModel {
 				);
 		}
 
+		model.myPrefixListener = listener;
 		plugin.readModel(model);
+		model.myPrefixListener = null;
 		return model;
 	}
 
@@ -77,6 +83,20 @@ public abstract class BookModel {
 
 	private LabelResolver myResolver;
 
+	public interface PrefixListener {
+		// is called from the reading thread with a model of the opening
+		// paragraphs of the book, while the rest of the book is read
+		void onTextModelPrefix(ZLTextModel prefix);
+	}
+
+	private PrefixListener myPrefixListener;
+
+	protected void onTextModelPrefix(ZLTextModel prefix) {
+		if (myPrefixListener != null) {
+			myPrefixListener.onTextModelPrefix(prefix);
+		}
+	}
+
 	public void setLabelResolver(LabelResolver resolver) {
 		myResolver = resolver;
 	}
@@ -48,6 +48,33 @@ public class JavaBookModel extends BookModelImpl {
 		return model;
 	}
 
+	@Override
+	protected Label getLabelInternal(String id) {
+		final int len = id.length();
+		final int size = myInternalHyperlinks.size();
+
+		for (int i = 0; i < size; ++i) {
+			final char[] block = myInternalHyperlinks.block(i);
+			for (int offset = 0; offset < block.length; ) {
+				final int labelLength = (int)block[offset++];
+				if (labelLength == 0) {
+					break;
+				}
+				final int idLength = (int)block[offset + labelLength];
+				if ((labelLength != len) || !id.equals(new String(block, offset, labelLength))) {
+					offset += labelLength + idLength + 3;
+					continue;
+				}
+				offset += labelLength + 1;
+				final String modelId = (idLength > 0) ? new String(block, offset, idLength) : null;
+				offset += idLength;
+				final int paragraphNumber = (int)block[offset] + (((int)block[offset + 1]) << 16);
+				return new Label(modelId, paragraphNumber);
+			}
+		}
+		return null;
+	}
+
 	private char[] myCurrentLinkBlock;
 	private int myCurrentLinkBlockOffset;
 
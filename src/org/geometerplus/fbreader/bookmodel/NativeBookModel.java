@@ -19,6 +19,11 @@
 
 package org.geometerplus.fbreader.bookmodel;
 
+import java.util.HashMap;
+
+import org.geometerplus.zlibrary.core.filesystem.ZLFile;
+import org.geometerplus.zlibrary.core.image.ZLFileImage;
+
 import org.geometerplus.zlibrary.text.model.*;
 
 import org.geometerplus.fbreader.book.Book;
@@ -30,45 +35,155 @@ public class NativeBookModel extends BookModelImpl {
 		super(book);
 	}
 
+	// the links table is written by writeInternalHyperlinks()
+	// in JavaNativeFormatPlugin.cpp: a header block, then blocks
+	// of fixed size entries sorted by label, then a string pool
+	private static final int LINK_ENTRY_SIZE = 8;
+	private int myLabelsNumber;
+	private int myLinkEntriesPerBlock;
+	private int myLinkIndexBlocksNumber;
+	private int myLinkPoolBlockSize;
+
 	public void initInternalHyperlinks(String directoryName, String fileExtension, int blocksNumber) {
 		myInternalHyperlinks = new CachedCharStorageRO(directoryName, fileExtension, blocksNumber);
+		final char[] header = myInternalHyperlinks.block(0);
+		myLabelsNumber = readInt(header, 0);
+		myLinkEntriesPerBlock = readInt(header, 2);
+		myLinkIndexBlocksNumber = readInt(header, 4);
+		myLinkPoolBlockSize = readInt(header, 6);
+	}
+
+	private static int readInt(char[] block, int offset) {
+		return (int)block[offset] + (((int)block[offset + 1]) << 16);
+	}
+
+	private char[] linkPoolBlock(int offset) {
+		return myInternalHyperlinks.block(1 + myLinkIndexBlocksNumber + offset / myLinkPoolBlockSize);
 	}
 
-	private TOCTree myCurrentTree = TOCTree;
+	@Override
+	protected Label getLabelInternal(String id) {
+		final int len = id.length();
+		int low = 0;
+		int high = myLabelsNumber - 1;
+		while (low <= high) {
+			final int middle = (low + high) >>> 1;
+			final char[] block = myInternalHyperlinks.block(1 + middle / myLinkEntriesPerBlock);
+			final int offset = (middle % myLinkEntriesPerBlock) * LINK_ENTRY_SIZE;
+
+			final int labelOffset = readInt(block, offset);
+			final int labelLength = (int)block[offset + 2];
+			final char[] pool = linkPoolBlock(labelOffset);
+			final int start = labelOffset % myLinkPoolBlockSize;
+			final int common = Math.min(labelLength, len);
+			int diff = 0;
+			for (int i = 0; i < common && diff == 0; ++i) {
+				diff = pool[start + i] - id.charAt(i);
+			}
+			if (diff == 0) {
+				diff = labelLength - len;
+			}
 
-	public void addTOCItem(String text, int reference) {
-		myCurrentTree = new TOCTree(myCurrentTree);
-		myCurrentTree.setText(text);
-		myCurrentTree.setReference(myBookTextModel, reference);
+			if (diff < 0) {
+				low = middle + 1;
+			} else if (diff > 0) {
+				high = middle - 1;
+			} else {
+				final int modelIdLength = (int)block[offset + 3];
+				String modelId = null;
+				if (modelIdLength > 0) {
+					final int modelIdOffset = readInt(block, offset + 4);
+					modelId = new String(linkPoolBlock(modelIdOffset), modelIdOffset % myLinkPoolBlockSize, modelIdLength);
+				}
+				return new Label(modelId, readInt(block, offset + 6));
+			}
+		}
+		return null;
 	}
 
-	public void leaveTOCItem() {
-		myCurrentTree = myCurrentTree.Parent;
-		if (myCurrentTree == null) {
-			myCurrentTree = TOCTree;
+	// the items are given in the pre-order; the text of an item
+	// is the next textLengths[i] characters of the text array
+	public void setTOC(int[] depths, int[] references, int[] textLengths, char[] text) {
+		TOCTree current = TOCTree;
+		int currentDepth = -1;
+		int textOffset = 0;
+		for (int i = 0; i < depths.length; ++i) {
+			for (; currentDepth >= depths[i]; --currentDepth) {
+				current = current.Parent;
+			}
+			current = new TOCTree(current);
+			currentDepth = depths[i];
+			if (textLengths[i] > 0) {
+				current.setText(new String(text, textOffset, textLengths[i]));
+				textOffset += textLengths[i];
+			}
+			current.setReference(myBookTextModel, references[i]);
 		}
 	}
 
 	public ZLTextModel createTextModel(
 		String id, String language, int paragraphsNumber,
 		int[] entryIndices, int[] entryOffsets,
-		int[] paragraphLenghts, int[] textSizes, byte[] paragraphKinds,
+		int[] paragraphLenghts, int[] textSizes, byte[] paragraphKinds, char[] styleTable,
 		String directoryName, String fileExtension, int blocksNumber
 	) {
 		return new ZLTextNativeModel(
 			id, language, paragraphsNumber,
 			entryIndices, entryOffsets,
-			paragraphLenghts, textSizes, paragraphKinds,
+			paragraphLenghts, textSizes, paragraphKinds, styleTable,
 			directoryName, fileExtension, blocksNumber, myImageMap
 		);
 	}
 
+	// an image is described by four numbers in the descriptors array:
+	// indices of its mime type, its file path and its encoding in the
+	// strings array, and the number of its blocks; the blocks of all
+	// the images go one after another in the offsets and sizes arrays
+	public void addImages(String[] ids, String[] strings, int[] descriptors, int[] offsets, int[] sizes) {
+		final ZLFile[] files = new ZLFile[strings.length];
+		int blockIndex = 0;
+		for (int i = 0; i < ids.length; ++i) {
+			final int pathIndex = descriptors[4 * i + 1];
+			final int blocksNumber = descriptors[4 * i + 3];
+			if (files[pathIndex] == null) {
+				files[pathIndex] = ZLFile.createFileByPath(strings[pathIndex]);
+			}
+			final int[] imageOffsets = new int[blocksNumber];
+			final int[] imageSizes = new int[blocksNumber];
+			System.arraycopy(offsets, blockIndex, imageOffsets, 0, blocksNumber);
+			System.arraycopy(sizes, blockIndex, imageSizes, 0, blocksNumber);
+			blockIndex += blocksNumber;
+			addImage(ids[i], new ZLFileImage(
+				strings[descriptors[4 * i]], files[pathIndex], strings[descriptors[4 * i + 2]],
+				imageOffsets, imageSizes
+			));
+		}
+	}
+
 	public void setBookTextModel(ZLTextModel model) {
 		myBookTextModel = model;
 	}
 
-	public void setFootnoteModel(ZLTextModel model) {
-		myFootnotes.put(model.getId(), model);
+	public void setBookTextModelPrefix(ZLTextModel model) {
+		onTextModelPrefix(model);
+	}
+
+	// all the footnotes are stored in a single model; a footnote consists of
+	// one or more runs of its paragraphs, each run lasts up to the next one
+	private ZLTextNativeModel myFootnotesModel;
+	private String[] myFootnoteRunIds;
+	private int[] myFootnoteRunStarts;
+	// footnote id -> index of its first run
+	private HashMap<String,Integer> myFootnoteFirstRuns;
+
+	public void setFootnotes(ZLTextModel model, String[] runIds, int[] runStarts) {
+		myFootnotesModel = (ZLTextNativeModel)model;
+		myFootnoteRunIds = runIds;
+		myFootnoteRunStarts = runStarts;
+		myFootnoteFirstRuns = new HashMap<String,Integer>(runIds.length * 4 / 3 + 1);
+		for (int i = runIds.length - 1; i >= 0; --i) {
+			myFootnoteFirstRuns.put(runIds[i], i);
+		}
 	}
 
 	@Override
@@ -77,7 +192,37 @@ public class NativeBookModel extends BookModelImpl {
 	}
 
 	@Override
-	public ZLTextModel getFootnoteModel(String id) {
-		return myFootnotes.get(id);
+	public synchronized ZLTextModel getFootnoteModel(String id) {
+		ZLTextModel model = myFootnotes.get(id);
+		if (model != null || myFootnotesModel == null) {
+			return model;
+		}
+		final Integer first = myFootnoteFirstRuns.get(id);
+		if (first == null) {
+			return null;
+		}
+
+		int runsNumber = 0;
+		for (int i = first; i < myFootnoteRunIds.length; ++i) {
+			if (id.equals(myFootnoteRunIds[i])) {
+				++runsNumber;
+			}
+		}
+		final int[] starts = new int[runsNumber];
+		final int[] lengths = new int[runsNumber];
+		int count = 0;
+		for (int i = first; i < myFootnoteRunIds.length; ++i) {
+			if (id.equals(myFootnoteRunIds[i])) {
+				starts[count] = myFootnoteRunStarts[i];
+				lengths[count] = (i + 1 < myFootnoteRunStarts.length
+					? myFootnoteRunStarts[i + 1]
+					: myFootnotesModel.getParagraphsNumber()) - starts[count];
+				++count;
+			}
+		}
+
+		model = new ZLTextNativeModel(id, myFootnotesModel, starts, lengths);
+		myFootnotes.put(id, model);
+		return model;
 	}
 }
@@ -194,8 +194,12 @@ public final class FBReaderApp extends ZLApplication {
 	}
 
 	private void setBookmarkHighlightings(ZLTextView view, String modelId) {
+		setBookmarkHighlightings(view, Model.Book, modelId);
+	}
+
+	private void setBookmarkHighlightings(ZLTextView view, Book book, String modelId) {
 		view.removeHighlightings(BookmarkHighlighting.class);
-		for (BookmarkQuery query = new BookmarkQuery(Model.Book, 20); ; query = query.next()) {
+		for (BookmarkQuery query = new BookmarkQuery(book, 20); ; query = query.next()) {
 			final List<Bookmark> bookmarks = Collection.bookmarks(query);
 			if (bookmarks.isEmpty()) {
 				break;
@@ -251,12 +255,45 @@ public final class FBReaderApp extends ZLApplication {
 		System.gc();
 		System.gc();
 		try {
-			Model = BookModel.createModel(book);
+			final Book openedBook = book;
+			final ZLTextPosition storedPosition = Collection.getStoredPosition(book.getId());
+			final boolean[] prefixShown = new boolean[1];
+			Model = BookModel.createModel(book, new BookModel.PrefixListener() {
+				public void onTextModelPrefix(ZLTextModel prefix) {
+					// the opening pages are shown before the book is read completely;
+					// no need to show them if the stored position is further
+					if (storedPosition != null && storedPosition.getParagraphIndex() >= prefix.getParagraphsNumber()) {
+						return;
+					}
+					// Model is still null here, so TOC, footnotes, labels and
+					// the other actions that need the whole book stay disabled;
+					// the view is painted on the UI thread while this one goes on
+					synchronized (BookTextView) {
+						BookTextView.setModel(prefix);
+						setBookmarkHighlightings(BookTextView, openedBook, null);
+						BookTextView.gotoPosition(storedPosition);
+						setView(BookTextView);
+						getViewWidget().reset();
+						getViewWidget().repaint();
+						prefixShown[0] = true;
+					}
+					hideMessage();
+				}
+			});
 			Collection.saveBook(book);
 			ZLTextHyphenator.Instance().load(book.getLanguage());
-			BookTextView.setModel(Model.getTextModel());
-			setBookmarkHighlightings(BookTextView, null);
-			BookTextView.gotoPosition(Collection.getStoredPosition(book.getId()));
+			synchronized (BookTextView) {
+				// the prefix might have been read on; the reading goes on
+				// from the same position in the complete model, unless
+				// the prefix has not been laid out yet
+				final ZLTextPosition position =
+					prefixShown[0] && !BookTextView.getStartCursor().isNull()
+						? new ZLTextFixedPosition(BookTextView.getStartCursor())
+						: storedPosition;
+				BookTextView.setModel(Model.getTextModel());
+				setBookmarkHighlightings(BookTextView, null);
+				BookTextView.gotoPosition(position);
+			}
 			if (bookmark == null) {
 				setView(BookTextView);
 			} else {
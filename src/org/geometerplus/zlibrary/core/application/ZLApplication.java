@@ -81,6 +81,12 @@ public abstract class ZLApplication {
 		}
 	}
 
+	protected void hideMessage() {
+		if (myWindow != null) {
+			myWindow.hideMessage();
+		}
+	}
+
 	protected void processException(Exception e) {
 		if (myWindow != null) {
 			myWindow.processException(e);
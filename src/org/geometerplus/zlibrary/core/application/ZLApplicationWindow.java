@@ -24,6 +24,7 @@ import org.geometerplus.zlibrary.core.view.ZLViewWidget;
 public interface ZLApplicationWindow {
 	void setWindowTitle(String title);
 	void runWithMessage(String key, Runnable runnable, Runnable postAction);
+	void hideMessage();
 	void processException(Exception e);
 
 	void refresh();
@@ -28,7 +28,7 @@ public class ZLTextNativeModel extends ZLTextPlainModel {
 		String id, String language, int paragraphsNumber,
 		int[] entryIndices, int[] entryOffsets,
 		int[] paragraphLengths, int[] textSizes,
-		byte[] paragraphKinds,
+		byte[] paragraphKinds, char[] styleTable,
 		String directoryName, String fileExtension, int blocksNumber,
 		Map<String,ZLImage> imageMap
 	) {
@@ -39,5 +39,47 @@ public class ZLTextNativeModel extends ZLTextPlainModel {
 			imageMap
 		);
 		myParagraphsNumber = paragraphsNumber;
+		myStyleTable = readStyleTable(styleTable);
+	}
+
+	// a model of the paragraph runs [runStarts[i], runStarts[i] + runLengths[i])
+	// of the base model; the storage and the style table are shared
+	public ZLTextNativeModel(String id, ZLTextNativeModel base, int[] runStarts, int[] runLengths) {
+		super(
+			id, base.getLanguage(),
+			null, null, null, null, null,
+			base.myStorage, base.myImageMap
+		);
+		int paragraphsNumber = 0;
+		for (int length : runLengths) {
+			paragraphsNumber += length;
+		}
+		myStartEntryIndices = new int[paragraphsNumber];
+		myStartEntryOffsets = new int[paragraphsNumber];
+		myParagraphLengths = new int[paragraphsNumber];
+		myTextSizes = new int[paragraphsNumber];
+		myParagraphKinds = new byte[paragraphsNumber];
+
+		int index = 0;
+		int textSize = 0;
+		for (int i = 0; i < runStarts.length; ++i) {
+			final int start = runStarts[i];
+			final int length = runLengths[i];
+			System.arraycopy(base.myStartEntryIndices, start, myStartEntryIndices, index, length);
+			System.arraycopy(base.myStartEntryOffsets, start, myStartEntryOffsets, index, length);
+			System.arraycopy(base.myParagraphLengths, start, myParagraphLengths, index, length);
+			System.arraycopy(base.myParagraphKinds, start, myParagraphKinds, index, length);
+			// text sizes are cumulative
+			int previous = start > 0 ? base.myTextSizes[start - 1] : 0;
+			for (int j = 0; j < length; ++j) {
+				final int current = base.myTextSizes[start + j];
+				textSize += current - previous;
+				myTextSizes[index + j] = textSize;
+				previous = current;
+			}
+			index += length;
+		}
+		myParagraphsNumber = paragraphsNumber;
+		myStyleTable = base.myStyleTable;
 	}
 }
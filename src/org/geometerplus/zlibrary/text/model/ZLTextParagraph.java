@@ -30,6 +30,7 @@ public interface ZLTextParagraph {
 		byte STYLE_CLOSE = 7;
 		byte FIXED_HSPACE = 8;
 		byte RESET_BIDI = 9;
+		byte STYLE_REFERENCE = 10;
 	}
 
 	interface EntryIterator {
@@ -33,6 +33,7 @@ public class ZLTextPlainModel implements ZLTextModel, ZLTextStyleEntry.Feature {
 	protected int[] myParagraphLengths;
 	protected int[] myTextSizes;
 	protected byte[] myParagraphKinds;
+	protected ZLTextStyleEntry[] myStyleTable;
 
 	protected int myParagraphsNumber;
 
@@ -188,34 +189,19 @@ public class ZLTextPlainModel implements ZLTextModel, ZLTextStyleEntry.Feature {
 				case ZLTextParagraph.Entry.STYLE_CSS:
 				case ZLTextParagraph.Entry.STYLE_OTHER:
 				{
-					final ZLTextStyleEntry entry =
-						type == ZLTextParagraph.Entry.STYLE_CSS
-							? new ZLTextCSSStyleEntry()
-							: new ZLTextOtherStyleEntry();
-
-					final short mask = (short)data[dataOffset++];
-					for (int i = 0; i < NUMBER_OF_LENGTHS; ++i) {
-						if (ZLTextStyleEntry.isFeatureSupported(mask, i)) {
-							final short size = (short)data[dataOffset++];
-							final byte unit = (byte)data[dataOffset++];
-							entry.setLength(i, size, unit);
-						}
-					}
-					if (ZLTextStyleEntry.isFeatureSupported(mask, ALIGNMENT_TYPE)) {
-						final short value = (short)data[dataOffset++];
-						entry.setAlignmentType((byte)(value & 0xFF));
-					}
-					if (ZLTextStyleEntry.isFeatureSupported(mask, FONT_FAMILY)) {
-						final short familyLength = (short)data[dataOffset++];
-						entry.setFontFamily(new String(data, dataOffset, familyLength));
-						dataOffset += familyLength;
-					}
-					if (ZLTextStyleEntry.isFeatureSupported(mask, FONT_STYLE_MODIFIER)) {
-						final short value = (short)data[dataOffset++];
-						entry.setFontModifiers((byte)(value & 0xFF), (byte)((value >> 8) & 0xFF));
-					}
-
+					final ZLTextStyleEntry entry = createStyleEntry(type);
+					dataOffset = readStyleEntry(entry, data, dataOffset);
 					myStyleEntry = entry;
+					break;
+				}
+				case ZLTextParagraph.Entry.STYLE_REFERENCE:
+				{
+					final ZLTextStyleEntry entry = myStyleTable[(int)data[dataOffset++]];
+					myType = entry instanceof ZLTextCSSStyleEntry
+						? ZLTextParagraph.Entry.STYLE_CSS
+						: ZLTextParagraph.Entry.STYLE_OTHER;
+					myStyleEntry = entry;
+					break;
 				}
 				case ZLTextParagraph.Entry.STYLE_CLOSE:
 					// No data
@@ -229,6 +215,50 @@ public class ZLTextPlainModel implements ZLTextModel, ZLTextStyleEntry.Feature {
 		}
 	}
 
+	private static ZLTextStyleEntry createStyleEntry(byte type) {
+		return type == ZLTextParagraph.Entry.STYLE_CSS
+			? new ZLTextCSSStyleEntry()
+			: new ZLTextOtherStyleEntry();
+	}
+
+	// reads the entry data following the type; returns the offset after it
+	private static int readStyleEntry(ZLTextStyleEntry entry, char[] data, int dataOffset) {
+		final short mask = (short)data[dataOffset++];
+		for (int i = 0; i < NUMBER_OF_LENGTHS; ++i) {
+			if (ZLTextStyleEntry.isFeatureSupported(mask, i)) {
+				final short size = (short)data[dataOffset++];
+				final byte unit = (byte)data[dataOffset++];
+				entry.setLength(i, size, unit);
+			}
+		}
+		if (ZLTextStyleEntry.isFeatureSupported(mask, ALIGNMENT_TYPE)) {
+			final short value = (short)data[dataOffset++];
+			entry.setAlignmentType((byte)(value & 0xFF));
+		}
+		if (ZLTextStyleEntry.isFeatureSupported(mask, FONT_FAMILY)) {
+			final short familyLength = (short)data[dataOffset++];
+			entry.setFontFamily(new String(data, dataOffset, familyLength));
+			dataOffset += familyLength;
+		}
+		if (ZLTextStyleEntry.isFeatureSupported(mask, FONT_STYLE_MODIFIER)) {
+			final short value = (short)data[dataOffset++];
+			entry.setFontModifiers((byte)(value & 0xFF), (byte)((value >> 8) & 0xFF));
+		}
+		return dataOffset;
+	}
+
+	// style entries written one after another, as in paragraphs
+	protected static ZLTextStyleEntry[] readStyleTable(char[] data) {
+		final ArrayList<ZLTextStyleEntry> table = new ArrayList<ZLTextStyleEntry>();
+		int dataOffset = 0;
+		while (dataOffset < data.length) {
+			final ZLTextStyleEntry entry = createStyleEntry((byte)data[dataOffset++]);
+			dataOffset = readStyleEntry(entry, data, dataOffset);
+			table.add(entry);
+		}
+		return table.toArray(new ZLTextStyleEntry[table.size()]);
+	}
+
 	protected ZLTextPlainModel(
 		String id,
 		String language,